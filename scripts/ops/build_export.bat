@@ -0,0 +1,15 @@
+@echo off
+call "C:\Program Files\Microsoft Visual Studio\2022\Enterprise\VC\Auxiliary\Build\vcvars64.bat"
+
+cl ^
+  /std:c++17 ^
+  /EHsc ^
+  /MT ^
+  /W3 ^
+  /O2 ^
+  /D_CRT_SECURE_NO_WARNINGS ^
+  /wd4819 ^
+  /I . ^
+  /I "C:\Users\insighter\workspace\sdk\tobii\64\include" ^
+  syncorder\export.cpp ^
+  /Fe:bin\exporter.exe
\ No newline at end of file
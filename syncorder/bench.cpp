@@ -0,0 +1,1159 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// local
+#include <syncorder/gonfig/gonfig.h>
+#include <syncorder/devices/common/broker_base.h>
+#include <syncorder/devices/common/frame_pool.h>
+#include <syncorder/io/async_writer.h>
+#include <syncorder/monitoring/histogram.h>
+#include <syncorder/monitoring/process_cpu.h>
+#include <syncorder/devices/tobii/buffer.cpp>
+#include <syncorder/devices/tobii/gaze_log.cpp>
+#include <syncorder/devices/realsense/buffer.cpp>
+#include <syncorder/devices/tobii/verifier.cpp>
+
+
+/**
+ * @struct BenchOptions
+ * Shared knobs, from the command line.
+ */
+
+struct BenchOptions {
+    double seconds = 5.0;   // --bench_seconds: length of each timed run
+    std::string dir;        // --bench_dir: scratch files, removed afterwards
+    std::size_t session_mb = 256;  // --bench_session_mb: size of the synthetic gaze CSVs
+};
+
+BenchOptions bench_options;
+
+using BenchClock = std::chrono::steady_clock;
+
+double secondsSince(BenchClock::time_point begin) {
+    return std::chrono::duration<double>(BenchClock::now() - begin).count();
+}
+
+
+/**
+ * @class NullBroker
+ * Broker that consumes batches and does nothing with them.
+ */
+
+template<typename T>
+class NullBroker : public TBBroker<T> {
+private:
+    std::atomic<std::uint64_t> processed_{0};
+
+public:
+    std::uint64_t processed() const {
+        return processed_.load(std::memory_order_acquire);
+    }
+
+protected:
+    void _process(const T& data) override {
+        _processBatch(&data, 1);
+    }
+
+    void _processBatch(const T* data, std::size_t count) override {
+        processed_.fetch_add(count, std::memory_order_release);
+    }
+};
+
+/**
+ * @class PollingBroker
+ * The broker loop before the buffers could wake it: look, and if the ring
+ * is empty sleep 1 ms.
+ */
+
+template<typename T>
+class PollingBroker : public NullBroker<T> {
+protected:
+    void _broker() override {
+        if (this->_processAvailable() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+};
+
+
+/**
+ * @brief enqueue-to-process latency and idle CPU, parked vs 1 ms polling
+ *
+ * A producer enqueues at the device rate on an absolute schedule; the
+ * buffer's own queueing-delay histogram (enqueue until the broker releases
+ * the item) gives the percentiles. Batching is off so only the wakeup is
+ * measured. Idle CPU is taken over one second with nothing enqueued.
+ */
+
+template<typename Buffer, typename Broker, typename Make>
+void runWakeLatency(std::ostream& log, const char* label, double rate_hz, Make make) {
+    Buffer buffer;
+    buffer.setCapacity(ringCapacity(rate_hz, 2.0));
+
+    Broker broker;
+    broker.setup(&buffer);
+    broker.start();
+    buffer.start();
+
+    const auto period = std::chrono::duration_cast<BenchClock::duration>(std::chrono::duration<double>(1.0 / rate_hz));
+    const auto begin = BenchClock::now();
+    std::uint64_t sent = 0;
+    while (secondsSince(begin) < bench_options.seconds) {
+        buffer.enqueue(make(sent++));
+        std::this_thread::sleep_until(begin + period * static_cast<std::int64_t>(sent));
+    }
+    while (broker.processed() < sent && secondsSince(begin) < bench_options.seconds + 1.0) std::this_thread::yield();
+
+    double cpu_begin = processCpuSeconds();
+    auto idle_begin = BenchClock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    double idle_cpu = (processCpuSeconds() - cpu_begin) / secondsSince(idle_begin);
+
+    buffer.stop();
+    broker.stop();
+
+    const Histogram& delay = buffer.delayHistogram();
+    log << "  " << std::left << std::setw(28) << label << std::right
+        << " p50 " << std::setw(6) << delay.quantile(0.50) << " us"
+        << ", p99 " << std::setw(6) << delay.quantile(0.99) << " us"
+        << ", max " << std::setw(6) << delay.maximum() << " us"
+        << "; idle cpu " << std::fixed << std::setprecision(2) << idle_cpu * 100.0 << "%" << std::defaultfloat
+        << " (" << broker.processed() << "/" << sent << ")\n";
+}
+
+void benchWakeLatency(std::ostream& log) {
+    auto gaze = [](std::uint64_t n) {
+        TobiiBufferData sample{};
+        sample.system_time_stamp = static_cast<std::int64_t>(n);
+        return sample;
+    };
+    auto frameset = [](std::uint64_t n) {
+        RealsenseBufferData frames;
+        frames.arrival = static_cast<double>(n);
+        return frames;
+    };
+
+    runWakeLatency<TobiiBuffer, NullBroker<TobiiBufferData>>(log, "tobii 600 Hz, park", 600.0, gaze);
+    runWakeLatency<TobiiBuffer, PollingBroker<TobiiBufferData>>(log, "tobii 600 Hz, poll 1 ms", 600.0, gaze);
+    runWakeLatency<RealsenseBuffer, NullBroker<RealsenseBufferData>>(log, "realsense 60 Hz, park", 60.0, frameset);
+    runWakeLatency<RealsenseBuffer, PollingBroker<RealsenseBufferData>>(log, "realsense 60 Hz, poll 1 ms", 60.0, frameset);
+}
+
+
+/**
+ * @class GazeSink
+ * Stands in for a broker's virtual _process/_processBatch.
+ */
+
+class GazeSink {
+public:
+    std::int64_t checksum = 0;
+
+    virtual ~GazeSink() = default;
+
+    virtual void process(const TobiiBufferData& data) {
+        checksum += data.system_time_stamp;
+    }
+
+    virtual void processBatch(const TobiiBufferData* data, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) checksum += data[i].system_time_stamp;
+    }
+};
+
+// one item per _front/_pop and per virtual call, as before the bulk API
+std::size_t drainSingle(TobiiBuffer& buffer, GazeSink& sink) {
+    std::size_t count = 0;
+    while (TobiiBufferData* item = buffer._front()) {
+        sink.process(*item);
+        buffer._pop();
+        count++;
+    }
+    return count;
+}
+
+// what TBBroker does now: one _frontBulk/_popBulk and one call per contiguous run
+std::size_t drainBulk(TobiiBuffer& buffer, GazeSink& sink) {
+    std::size_t count = 0;
+    TobiiBufferData* first = nullptr;
+    while (std::size_t run = buffer._frontBulk(first, 256)) {
+        sink.processBatch(first, run);
+        buffer._popBulk(run);
+        count += run;
+    }
+    return count;
+}
+
+
+/**
+ * @brief items/sec through the consumer side, single vs bulk dequeue
+ *
+ * Same thread: enqueue a batch, drain it, repeat; the enqueue side is the
+ * same for both, so the difference is the dequeue path. Two threads: a
+ * producer enqueues as fast as the ring allows while the consumer drains.
+ */
+
+void benchBulkDequeue(std::ostream& log) {
+    constexpr std::size_t ITEMS = 4000000;
+
+    GazeSink sink;
+    TobiiBufferData sample{};
+
+    for (std::size_t batch : {1, 6, 32, 256}) {
+        double rate[2] = {0.0, 0.0};
+        for (int bulk = 0; bulk < 2; ++bulk) {
+            TobiiBuffer buffer;
+            buffer.setCapacity(1024);
+            buffer.start();
+
+            auto begin = BenchClock::now();
+            for (std::size_t done = 0; done < ITEMS; ) {
+                for (std::size_t i = 0; i < batch; ++i) {
+                    sample.system_time_stamp = static_cast<std::int64_t>(done + i);
+                    buffer.enqueue(sample);
+                }
+                done += bulk ? drainBulk(buffer, sink) : drainSingle(buffer, sink);
+            }
+            rate[bulk] = ITEMS / secondsSince(begin);
+        }
+
+        log << "  same thread, batch " << std::setw(3) << batch
+            << ": single " << std::setw(6) << std::fixed << std::setprecision(1) << rate[0] / 1e6 << " M items/s"
+            << ", bulk " << std::setw(6) << rate[1] / 1e6 << " M items/s"
+            << " (x" << std::setprecision(2) << rate[1] / rate[0] << ")\n" << std::defaultfloat;
+    }
+
+    double rate[2] = {0.0, 0.0};
+    for (int bulk = 0; bulk < 2; ++bulk) {
+        TobiiBuffer buffer;
+        buffer.setCapacity(4096);
+        buffer.start();
+
+        std::atomic<bool> producing{true};
+        auto begin = BenchClock::now();
+        std::thread producer([&]() {
+            TobiiBufferData item{};
+            for (std::size_t n = 0; n < ITEMS; ++n) {
+                item.system_time_stamp = static_cast<std::int64_t>(n);
+                while (!buffer.enqueue(item)) std::this_thread::yield();
+            }
+            producing.store(false, std::memory_order_release);
+        });
+
+        std::size_t consumed = 0;
+        while (consumed < ITEMS) {
+            std::size_t got = bulk ? drainBulk(buffer, sink) : drainSingle(buffer, sink);
+            consumed += got;
+            if (got == 0) std::this_thread::yield();
+        }
+        producer.join();
+        rate[bulk] = ITEMS / secondsSince(begin);
+    }
+
+    log << "  two threads, streaming: single " << std::fixed << std::setprecision(1) << rate[0] / 1e6 << " M items/s"
+        << ", bulk " << rate[1] / 1e6 << " M items/s" << std::defaultfloat
+        << (std::thread::hardware_concurrency() > 1 ? "" : " (one core: scheduler bound)") << "\n";
+    log << "  checksum " << sink.checksum << "\n";
+}
+
+
+/**
+ * @class LegacyRing
+ * BBuffer's ring before the cache-line split, kept as the baseline: head,
+ * storage, tail and gate packed together, no cached copy of the opposite
+ * index (every enqueue and dequeue reads the other side's line), % N.
+ */
+
+template<typename T, std::size_t N>
+class LegacyRing {
+private:
+    std::atomic<std::size_t> m_head{0};
+    std::array<T, N> m_buff{};
+    std::atomic<std::size_t> m_tail{0};
+    std::atomic<bool> gate_{false};
+    std::atomic<bool> waiting_{false};
+
+public:
+    bool enqueue(const T& val) noexcept {
+        if (gate_.load(std::memory_order_acquire)) return false;
+
+        std::size_t current_tail = m_tail.load(std::memory_order_relaxed);
+        if (current_tail - m_head.load(std::memory_order_acquire) >= N) return false;
+
+        m_buff[current_tail % N] = val;
+        m_tail.store(current_tail + 1, std::memory_order_release);
+
+        // what _notify() cost when nobody was parked
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        waiting_.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    std::size_t _frontBulk(T*& first, std::size_t max) noexcept {
+        std::size_t current_head = m_head.load(std::memory_order_relaxed);
+        std::size_t available = m_tail.load(std::memory_order_acquire) - current_head;
+
+        std::size_t offset = current_head % N;
+        first = &m_buff[offset];
+        return (std::min)({available, max, N - offset});
+    }
+
+    void _popBulk(std::size_t count) noexcept {
+        m_head.store(m_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+};
+
+// the ring as shipped, sized like the Tobii ring
+template<typename T>
+class CurrentRing : public BBuffer<T, DYNAMIC_CAPACITY> {
+public:
+    CurrentRing() {
+        this->setCapacity(4096);
+        this->start();
+    }
+};
+
+template<typename T>
+T benchItem(std::uint64_t n) {
+    T item{};
+    if constexpr (std::is_same_v<T, TobiiBufferData>) item.system_time_stamp = static_cast<std::int64_t>(n);
+    else item = static_cast<T>(n);
+    return item;
+}
+
+template<typename T>
+std::uint64_t benchKey(const T& item) {
+    if constexpr (std::is_same_v<T, TobiiBufferData>) return static_cast<std::uint64_t>(item.system_time_stamp);
+    else return static_cast<std::uint64_t>(item);
+}
+
+// producer thread -> consumer thread, items/s
+template<typename Ring, typename T>
+double ringThroughput(std::uint64_t items) {
+    auto ring = std::make_unique<Ring>();
+
+    auto begin = BenchClock::now();
+    std::thread producer([&]() {
+        for (std::uint64_t n = 0; n < items; ++n) {
+            T item = benchItem<T>(n);
+            while (!ring->enqueue(item)) std::this_thread::yield();
+        }
+    });
+
+    std::uint64_t consumed = 0;
+    std::uint64_t checksum = 0;
+    while (consumed < items) {
+        T* first = nullptr;
+        std::size_t count = ring->_frontBulk(first, 256);
+        if (count == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (std::size_t i = 0; i < count; ++i) checksum += benchKey(first[i]);
+        ring->_popBulk(count);
+        consumed += count;
+    }
+    producer.join();
+
+    double rate = items / secondsSince(begin);
+    return (checksum == items * (items - 1) / 2) ? rate : 0.0;
+}
+
+// one item there and back through two rings, spinning; round trip in ns
+template<typename Ring, typename T>
+void ringPingPong(std::uint64_t round_trips, Histogram& round_trip_ns) {
+    auto there = std::make_unique<Ring>();
+    auto back = std::make_unique<Ring>();
+
+    std::thread echo([&]() {
+        for (std::uint64_t n = 0; n < round_trips; ++n) {
+            T* first = nullptr;
+            while (there->_frontBulk(first, 1) == 0) _mm_pause();
+            T item = *first;
+            there->_popBulk(1);
+            while (!back->enqueue(item)) _mm_pause();
+        }
+    });
+
+    for (std::uint64_t n = 0; n < round_trips; ++n) {
+        auto begin = BenchClock::now();
+        while (!there->enqueue(benchItem<T>(n))) _mm_pause();
+
+        T* first = nullptr;
+        while (back->_frontBulk(first, 1) == 0) _mm_pause();
+        back->_popBulk(1);
+        round_trip_ns.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - begin).count()));
+    }
+    echo.join();
+}
+
+template<typename T>
+void runRing(std::ostream& log, const char* label, std::uint64_t items) {
+    double legacy = ringThroughput<LegacyRing<T, 4096>, T>(items);
+    double current = ringThroughput<CurrentRing<T>, T>(items);
+
+    log << "  " << label << " throughput: previous " << std::fixed << std::setprecision(1) << legacy / 1e6 << " M items/s"
+        << ", current " << current / 1e6 << " M items/s" << std::defaultfloat << "\n";
+
+    if (std::thread::hardware_concurrency() < 2) {
+        log << "  " << label << " round trip: skipped, needs two cores\n";
+        return;
+    }
+
+    Histogram legacy_rtt;
+    Histogram current_rtt;
+    ringPingPong<LegacyRing<T, 4096>, T>(200000, legacy_rtt);
+    ringPingPong<CurrentRing<T>, T>(200000, current_rtt);
+    log << "  " << label << " round trip (ns): previous p50 " << legacy_rtt.quantile(0.50) << ", p99 " << legacy_rtt.quantile(0.99)
+        << "; current p50 " << current_rtt.quantile(0.50) << ", p99 " << current_rtt.quantile(0.99) << "\n";
+}
+
+
+/**
+ * @brief SPSC ring throughput and round trip, previous layout vs current
+ *
+ * Both rings are 4096 slots and drained 256 at a time. The current one
+ * also stamps enqueue times and records occupancy and delay, so it does
+ * more work per item than the baseline; the clock read it costs is printed
+ * first. Numbers mean little on one core.
+ */
+
+void benchSpscRing(std::ostream& log) {
+    // the current ring stamps every enqueue with steady_clock (queueing delay telemetry)
+    constexpr int CLOCK_READS = 1000000;
+    std::int64_t sink = 0;
+    auto begin = BenchClock::now();
+    for (int i = 0; i < CLOCK_READS; ++i) sink += BenchClock::now().time_since_epoch().count() & 1;
+    log << "  steady_clock::now(): " << std::fixed << std::setprecision(1) << secondsSince(begin) * 1e9 / CLOCK_READS
+        << " ns per call" << std::defaultfloat << (sink < 0 ? "!" : "") << "\n";
+
+    runRing<std::uint64_t>(log, "8 B items ", 20000000);
+    runRing<TobiiBufferData>(log, "96 B gaze ", 5000000);
+}
+
+
+// the gaze row as TobiiBroker::_write streamed it before CsvFormatter
+void writeGazeStreamRow(std::ostream& csv, std::uint64_t index, double frame_timestamp, const TobiiBufferData& sample) {
+    std::ostringstream system_time_stamp;
+    system_time_stamp << std::fixed << std::setprecision(14) << frame_timestamp;
+
+    csv << index << "," << system_time_stamp.str() << "," << sample.device_time_stamp << ",";
+
+    for (const TobiiGazeEye* eye : {&sample.left, &sample.right}) {
+        csv
+            << eye->display_x << "," << eye->display_y << ","
+            << eye->gaze_x << "," << eye->gaze_y << "," << eye->gaze_z << ","
+            << static_cast<int>(eye->gaze_validity) << ","
+            << eye->origin_x << "," << eye->origin_y << "," << eye->origin_z << ","
+            << static_cast<int>(eye->origin_validity) << ","
+            << eye->pupil_diameter << "," << static_cast<int>(eye->pupil_validity) << ",";
+    }
+    csv << "\n";
+}
+
+// plausible samples, with the odd invalid (NaN) eye and tiny or negative values
+std::vector<TobiiBufferData> benchGazeSamples(std::size_t count) {
+    std::vector<TobiiBufferData> samples(count);
+    std::uint32_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+
+    for (std::size_t i = 0; i < count; ++i) {
+        TobiiBufferData& sample = samples[i];
+        sample.device_time_stamp = 1000000000LL + static_cast<std::int64_t>(i) * 1667;
+        sample.system_time_stamp = 1700000000000000LL + static_cast<std::int64_t>(i) * 1667;
+
+        for (TobiiGazeEye* eye : {&sample.left, &sample.right}) {
+            eye->display_x = next();
+            eye->display_y = next() * 1e-5f;
+            eye->gaze_x = next() * 600.0f - 300.0f;
+            eye->gaze_y = next() * 400.0f - 200.0f;
+            eye->gaze_z = next() * 50.0f;
+            eye->origin_x = -next() * 40.0f;
+            eye->origin_y = next() * 1e-7f;
+            eye->origin_z = 600.0f + next() * 100.0f;
+            eye->pupil_diameter = 2.0f + next() * 4.0f;
+            eye->gaze_validity = eye->origin_validity = eye->pupil_validity = 1;
+            eye->reserved = 0;
+        }
+
+        if (i % 50 == 7) {
+            const float nan = std::numeric_limits<float>::quiet_NaN();
+            sample.right = TobiiGazeEye{nan, nan, nan, nan, nan, nan, nan, nan, nan, 0, 0, 0, 0};
+        }
+    }
+    return samples;
+}
+
+
+/**
+ * @brief gaze CSV rows/sec, ostream row vs CsvFormatter row
+ *
+ * Formats the same samples both ways in batches of 256, as the broker
+ * writes them, and first checks that both produce the same bytes.
+ */
+
+void benchCsvFormat(std::ostream& log) {
+    constexpr std::size_t SAMPLES = 4096;
+    constexpr std::size_t BATCH = 256;
+
+    const auto samples = benchGazeSamples(SAMPLES);
+    auto frame_timestamp = [](std::uint64_t index) { return 1.7e12 + static_cast<double>(index) * 1.6667; };
+
+    std::ostringstream stream;
+    CsvFormatter formatter;
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        writeGazeStreamRow(stream, i, frame_timestamp(i), samples[i]);
+        writeGazeCsvRow(formatter, i, frame_timestamp(i), samples[i]);
+    }
+    const std::string expected = stream.str();
+    const std::string actual(formatter.data(), formatter.size());
+    log << "  identical bytes: " << (expected == actual ? "yes" : "NO") << " (" << expected.size() << " bytes, " << SAMPLES << " rows)\n";
+
+    auto run = [&](bool csv_formatter) {
+        std::uint64_t rows = 0;
+        std::size_t bytes = 0;
+        auto begin = BenchClock::now();
+        while (secondsSince(begin) < bench_options.seconds / 2) {
+            for (std::size_t b = 0; b < BATCH; ++b, ++rows) {
+                const TobiiBufferData& sample = samples[rows % SAMPLES];
+                if (csv_formatter) writeGazeCsvRow(formatter, rows, frame_timestamp(rows), sample);
+                else writeGazeStreamRow(stream, rows, frame_timestamp(rows), sample);
+            }
+            if (csv_formatter) {
+                bytes += formatter.size();
+                formatter.clear();
+            } else {
+                bytes += static_cast<std::size_t>(stream.tellp());
+                stream.str("");
+            }
+        }
+        double seconds = secondsSince(begin);
+        return std::pair<double, double>(rows / seconds, bytes / seconds);
+    };
+
+    stream.str("");
+    formatter.clear();
+    auto before = run(false);
+    auto after = run(true);
+    log << "  ostream      " << std::fixed << std::setprecision(2) << std::setw(7) << before.first / 1e6 << " M rows/s, "
+        << std::setw(7) << before.second / 1e6 << " MB/s\n"
+        << "  CsvFormatter " << std::setw(7) << after.first / 1e6 << " M rows/s, "
+        << std::setw(7) << after.second / 1e6 << " MB/s (x" << after.first / before.first << ")\n" << std::defaultfloat;
+}
+
+
+/**
+ * @class SlowStorage
+ * A disk that takes 2 ms plus 20 MB/s per write, and once a second holds
+ * one write for a further 300 ms (a flush or antivirus hiccup).
+ */
+
+class SlowStorage {
+private:
+    BenchClock::time_point next_hiccup_ = BenchClock::now() + std::chrono::seconds(1);
+    std::mutex mutex_;
+
+public:
+    void write(std::size_t bytes) {
+        auto delay = std::chrono::milliseconds(2) + std::chrono::microseconds(bytes / 20);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (BenchClock::now() >= next_hiccup_) {
+                delay += std::chrono::milliseconds(300);
+                next_hiccup_ = BenchClock::now() + std::chrono::seconds(1);
+            }
+        }
+        std::this_thread::sleep_for(delay);
+    }
+};
+
+class SlowAsyncWriter : public AsyncWriter {
+private:
+    SlowStorage& storage_;
+
+public:
+    explicit SlowAsyncWriter(SlowStorage& storage) : storage_(storage) {}
+    ~SlowAsyncWriter() override { close(); }
+
+protected:
+    void _writeBuffer(const char* data, std::size_t size) override {
+        storage_.write(size);
+        AsyncWriter::_writeBuffer(data, size);
+    }
+};
+
+
+/**
+ * @brief producer stalls on slow storage, writing on the broker thread vs AsyncWriter
+ *
+ * A broker emits 250-byte rows at 2400 rows/s on an absolute schedule.
+ * Before, rows went through a std::ofstream buffer (64 KB here) that the
+ * broker thread itself flushed; now they go to an AsyncWriter (4 x 256 KB).
+ * Reports the slowest write call and how far the broker fell behind its
+ * schedule, which is what the ring has to absorb.
+ */
+
+void benchSlowWriter(std::ostream& log) {
+    constexpr double ROWS_PER_SECOND = 2400.0;
+    constexpr std::size_t SYNC_BUFFER = 64 * 1024;
+
+    std::filesystem::create_directories(bench_options.dir);
+    const std::string row = std::string(249, 'x') + "\n";
+    const auto period = std::chrono::duration_cast<BenchClock::duration>(std::chrono::duration<double>(1.0 / ROWS_PER_SECOND));
+    // at least a couple of disk hiccups, whatever --bench_seconds says
+    const double seconds = (std::max)(bench_options.seconds, 3.0);
+
+    auto run = [&](const char* label, auto&& write_row, auto&& stalls) {
+        Histogram call_us;
+        double worst_lag_ms = 0.0;
+        std::uint64_t rows = 0;
+
+        const auto begin = BenchClock::now();
+        while (secondsSince(begin) < seconds) {
+            auto due = begin + period * static_cast<std::int64_t>(rows);
+            auto call = BenchClock::now();
+            worst_lag_ms = (std::max)(worst_lag_ms, std::chrono::duration<double, std::milli>(call - due).count());
+
+            write_row();
+            call_us.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(BenchClock::now() - call).count()));
+
+            rows++;
+            std::this_thread::sleep_until(begin + period * static_cast<std::int64_t>(rows));
+        }
+
+        log << "  " << std::left << std::setw(24) << label << std::right
+            << " write p99 " << std::setw(6) << call_us.quantile(0.99) << " us"
+            << ", max " << std::setw(7) << call_us.maximum() << " us"
+            << "; worst lag " << std::fixed << std::setprecision(1) << std::setw(6) << worst_lag_ms << " ms"
+            << " (" << static_cast<std::uint64_t>(worst_lag_ms * ROWS_PER_SECOND / 1000.0) << " rows)" << std::defaultfloat
+            << ", calls that waited on the disk " << stalls() << "\n";
+    };
+
+    {
+        SlowStorage storage;
+        std::ofstream file(bench_options.dir + "/slow_writer_sync.csv", std::ios::binary | std::ios::trunc);
+        std::string pending;
+        std::uint64_t flushes = 0;
+
+        run("broker thread, 64 KB",
+            [&]() {
+                pending += row;
+                if (pending.size() < SYNC_BUFFER) return;
+                storage.write(pending.size());
+                file.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+                pending.clear();
+                flushes++;
+            },
+            [&]() { return flushes; });
+    }
+
+    {
+        SlowStorage storage;
+        SlowAsyncWriter writer(storage);
+        AsyncWriterOptions options;
+        options.buffer_size = 256 * 1024;
+        options.buffer_count = 4;
+        writer.open(bench_options.dir + "/slow_writer_async.csv", options);
+
+        run("AsyncWriter, 4 x 256 KB",
+            [&]() { writer.write(row); },
+            [&]() { return writer.stalls(); });
+
+        writer.close();
+        log << "  AsyncWriter disk writes: p50 " << writer.writeTimeHistogram().quantile(0.50) << " us"
+            << ", max " << writer.writeTimeHistogram().maximum() << " us\n";
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(bench_options.dir + "/slow_writer_sync.csv", ec);
+    std::filesystem::remove(bench_options.dir + "/slow_writer_async.csv", ec);
+}
+
+
+/**
+ * @struct BenchFrameset
+ * A synthetic frameset in the ring: the SDK frame it pins, or the pool
+ * slot its pixels were copied into (or both, when the pool ran out).
+ */
+
+struct BenchFrameset {
+    FramePool::Lease sdk;
+    FramePool::Lease slab;
+};
+
+class BenchFramesetBuffer : public BBuffer<BenchFrameset, DYNAMIC_CAPACITY> {};
+
+
+/**
+ * @brief frameset copy cost vs SDK frames dropped, holding SDK frames vs FramePool
+ *
+ * The SDK side is modelled as a pool of 32 frames (RS2_OPTION_FRAMES_QUEUE_SIZE);
+ * when all 32 are pinned a new frameset is dropped upstream. Framesets of
+ * 640x480 RGB8 + Z16 arrive at 60 Hz while the broker stops for 1 s every
+ * 2 s. Holding SDK frames pins them until written; with the pool the
+ * payload is copied out and the SDK frame released in the callback.
+ */
+
+void benchFramePool(std::ostream& log) {
+    constexpr std::size_t PIXELS = 640 * 480;
+    constexpr std::size_t COLOR_BYTES = PIXELS * 3;
+    constexpr std::size_t FRAMESET_BYTES = COLOR_BYTES + PIXELS * 2;
+    constexpr std::size_t SDK_FRAMES = 32;
+    constexpr double RATE_HZ = 60.0;
+
+    // at least two broker stalls, whatever --bench_seconds says
+    const double seconds = (std::max)(bench_options.seconds, 4.0);
+    const std::size_t pool_slots = gonfig.realsense_frame_pool > 0 ? static_cast<std::size_t>(gonfig.realsense_frame_pool) : 64;
+    const auto period = std::chrono::duration_cast<BenchClock::duration>(std::chrono::duration<double>(1.0 / RATE_HZ));
+
+    for (int pooled = 0; pooled < 2; ++pooled) {
+        FramePool sdk(SDK_FRAMES, FRAMESET_BYTES);
+        std::unique_ptr<FramePool> pool = pooled ? std::make_unique<FramePool>(pool_slots, FRAMESET_BYTES) : nullptr;
+
+        BenchFramesetBuffer buffer;
+        buffer.setCapacity(1024);
+        buffer.start();
+
+        std::atomic<bool> running{true};
+        const auto begin = BenchClock::now();
+
+        // the broker: writes promptly except for a 1 s stall every 2 s
+        std::thread broker([&]() {
+            while (running.load(std::memory_order_acquire) || buffer._front()) {
+                if (std::fmod(secondsSince(begin), 2.0) >= 1.0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    continue;
+                }
+                BenchFrameset* first = nullptr;
+                std::size_t count = buffer._frontBulk(first, 64);
+                if (count == 0) {
+                    buffer._wait(std::chrono::milliseconds(5));
+                    continue;
+                }
+                buffer._popBulk(count);
+            }
+        });
+
+        Histogram copy_us;
+        std::uint64_t sent = 0;
+        std::uint64_t sdk_drops = 0;
+        while (secondsSince(begin) < seconds) {
+            FramePool::Lease frame = sdk.acquire();
+            if (!frame) {
+                sdk_drops++;
+            } else {
+                frame.data()[sent % FRAMESET_BYTES] = static_cast<std::uint8_t>(sent);
+
+                BenchFrameset item;
+                FramePool::Lease slab = pool ? pool->acquire() : FramePool::Lease();
+                if (slab) {
+                    auto copy_begin = BenchClock::now();
+                    std::memcpy(slab.data(), frame.data(), COLOR_BYTES);
+                    std::memcpy(slab.data() + COLOR_BYTES, frame.data() + COLOR_BYTES, FRAMESET_BYTES - COLOR_BYTES);
+                    copy_us.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(BenchClock::now() - copy_begin).count()));
+                    item.slab = std::move(slab);
+                } else {
+                    item.sdk = std::move(frame);
+                }
+                buffer.enqueue(std::move(item));
+            }
+
+            sent++;
+            std::this_thread::sleep_until(begin + period * static_cast<std::int64_t>(sent));
+        }
+
+        running.store(false, std::memory_order_release);
+        broker.join();
+
+        log << "  " << (pooled ? "frame pool" : "SDK frames") << ": " << sent << " framesets, SDK drops " << sdk_drops
+            << " (peak " << sdk.peakInUse() << "/" << SDK_FRAMES << " pinned)";
+        if (pool) {
+            double copy_cpu = copy_us.quantile(0.50) * 1e-6 * RATE_HZ * 100.0;
+            log << "; pool " << pool_slots << " x " << FRAMESET_BYTES / 1024 << " KB, peak " << pool->peakInUse()
+                << ", exhausted " << pool->exhausted()
+                << "; copy p50 " << copy_us.quantile(0.50) << " us, max " << copy_us.maximum() << " us"
+                << " (" << std::fixed << std::setprecision(1) << copy_cpu << "% of one core)" << std::defaultfloat;
+        }
+        log << "\n";
+    }
+}
+
+
+// the ring item before the compact record: the SDK struct, whole
+struct FullGazeItem {
+    TobiiResearchGazeData gazed;
+};
+
+std::int64_t gazeKey(const FullGazeItem& item) { return item.gazed.system_time_stamp; }
+std::int64_t gazeKey(const TobiiBufferData& item) { return item.system_time_stamp; }
+
+// samples/s packed, enqueued and read back; T is the ring item
+template<typename T, typename Pack>
+double gazeCopyRate(const std::vector<TobiiResearchGazeData>& source, std::uint64_t items, Pack pack, std::int64_t& checksum) {
+    BBuffer<T, DYNAMIC_CAPACITY> buffer;
+    buffer.setCapacity(4096);
+    buffer.start();
+
+    auto begin = BenchClock::now();
+    for (std::uint64_t done = 0; done < items; ) {
+        for (std::size_t i = 0; i < 256; ++i) buffer.enqueue(pack(source[(done + i) % source.size()]));
+
+        T* first = nullptr;
+        while (std::size_t count = buffer._frontBulk(first, 256)) {
+            for (std::size_t i = 0; i < count; ++i) checksum += gazeKey(first[i]);
+            buffer._popBulk(count);
+            done += count;
+        }
+    }
+    return items / secondsSince(begin);
+}
+
+
+/**
+ * @brief callback-to-broker copy bandwidth, full TobiiResearchGazeData vs TobiiBufferData
+ *
+ * Each sample is packed the way the callback does it (a struct copy
+ * before, toTobiiBufferData now), enqueued, and read back by the consumer
+ * 256 at a time on the same thread. The per-sample time is also shown as a
+ * share of one core at 1200 Hz.
+ */
+
+void benchGazeCopy(std::ostream& log) {
+    constexpr std::uint64_t ITEMS = 20000000;
+
+    std::vector<TobiiResearchGazeData> source(4096);
+    for (std::size_t i = 0; i < source.size(); ++i) {
+        source[i] = TobiiResearchGazeData{};
+        source[i].device_time_stamp = static_cast<std::int64_t>(i);
+        source[i].system_time_stamp = static_cast<std::int64_t>(i) * 3;
+        source[i].left_eye.pupil_data.diameter = 3.0f + static_cast<float>(i % 7);
+        source[i].right_eye.gaze_point.validity = TOBII_RESEARCH_VALIDITY_VALID;
+    }
+
+    std::int64_t checksum = 0;
+    double full = gazeCopyRate<FullGazeItem>(source, ITEMS,
+        [](const TobiiResearchGazeData& gazed) { return FullGazeItem{gazed}; }, checksum);
+    double compact = gazeCopyRate<TobiiBufferData>(source, ITEMS,
+        [](const TobiiResearchGazeData& gazed) { return toTobiiBufferData(gazed); }, checksum);
+
+    auto report = [&](const char* label, std::size_t size, double rate) {
+        log << "  " << label << std::setw(4) << size << " B: " << std::fixed << std::setprecision(1) << std::setw(6) << rate / 1e6 << " M samples/s, "
+            << std::setw(6) << rate * size * 2 / 1e9 << " GB/s copied (in and out), "
+            << std::setprecision(4) << 1200.0 / rate * 100.0 << "% of one core at 1200 Hz\n" << std::defaultfloat;
+    };
+    report("TobiiResearchGazeData ", sizeof(TobiiResearchGazeData), full);
+    report("TobiiBufferData       ", sizeof(TobiiBufferData), compact);
+    log << "  ring of 4096: " << sizeof(TobiiResearchGazeData) * 4096 / 1024 << " KB vs " << sizeof(TobiiBufferData) * 4096 / 1024
+        << " KB; checksum " << checksum << "\n";
+}
+
+
+// a gaze CSV as the broker writes it, about bytes long; every 97th sample has both eyes lost
+std::uint64_t writeBenchGazeCsv(const std::string& path, std::size_t bytes, double rate_hz, double first_ms) {
+    const auto samples = benchGazeSamples(4096);
+    std::uint64_t rows = 0;
+
+    std::ofstream csv(path, std::ios::binary | std::ios::trunc);
+    CsvFormatter out;
+    out.text(GAZE_CSV_HEADER, std::strlen(GAZE_CSV_HEADER));
+
+    std::size_t written = 0;
+    while (written < bytes) {
+        for (int i = 0; i < 1024; ++i, ++rows) {
+            TobiiBufferData sample = samples[rows % samples.size()];
+            if (rows % 97 == 0) sample.left.gaze_validity = sample.right.gaze_validity = 0;
+            writeGazeCsvRow(out, rows, first_ms + rows * 1000.0 / rate_hz, sample);
+        }
+        written += out.size();
+        out.flush(csv);
+    }
+    return rows;
+}
+
+// one video's window the way TobiiVerifier read it before the index: the whole CSV, every field split
+bool rescanCsvForVideo(const std::string& csv_path, double start, double end, int& total, int& failed) {
+    std::ifstream file(csv_path);
+    std::string line;
+    if (!std::getline(file, line) || line.find("index,") != 0) return false;
+
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+
+        std::istringstream iss(line);
+        std::vector<std::string> fields;
+        std::string field;
+        while (std::getline(iss, field, ',')) fields.push_back(field);
+        if (fields.size() < 20) continue;
+
+        double frame_timestamp = 0.0;
+        try {
+            frame_timestamp = std::stod(fields[1]);
+        } catch (...) {
+            continue;
+        }
+
+        double frame_time_sec = frame_timestamp / 1000.0;
+        if (frame_time_sec >= start && frame_time_sec <= end) {
+            total++;
+            if (fields[8] != "1" && fields[19] != "1") failed++;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief TobiiVerifier on a synthetic session vs rereading the CSV per video
+ *
+ * Writes a session of --bench_session_mb MB: a 1200 Hz gaze CSV as the
+ * broker writes it and a frame_timing.log with 30 videos, then runs
+ * TobiiVerifier on it (no worker threads, cache rebuilt). The old per-video
+ * rescan is timed for as many videos as fit in --bench_seconds and scaled
+ * to 30; its counts are checked against the verifier's result CSV.
+ */
+
+void benchSessionVerify(std::ostream& log) {
+    constexpr int VIDEOS = 30;
+    constexpr double RATE_HZ = 1200.0;
+    constexpr double START_SEC = 1000.0;
+
+    const std::string root = bench_options.dir + "/session_verify/";
+    const std::string session = root + "output/session_bench/";
+    const std::string csv_path = session + "tobii/tobii_data.csv";
+    std::filesystem::create_directories(session + "tobii");
+
+    auto begin = BenchClock::now();
+    const std::uint64_t rows = writeBenchGazeCsv(csv_path, bench_options.session_mb << 20, RATE_HZ, START_SEC * 1000.0);
+
+    const double span = rows / RATE_HZ / VIDEOS;
+    std::vector<std::pair<double, double>> windows;
+    {
+        std::ofstream timing(session + "frame_timing.log");
+        timing << std::fixed << std::setprecision(6);
+        for (int v = 0; v < VIDEOS; ++v) {
+            double start = START_SEC + v * span + 0.5;
+            double end = start + span - 1.0;
+            windows.emplace_back(start, end);
+            timing << "FIRST_FRAME " << start << " VIDEO_INDEX_" << v + 1 << "\n";
+            timing << "LAST_FRAME " << end << " VIDEO_INDEX_" << v + 1 << " NORMAL\n";
+        }
+    }
+    const double file_gb = std::filesystem::file_size(csv_path) / 1e9;
+    log << "  session: " << std::fixed << std::setprecision(2) << file_gb << " GB, " << rows << " rows, " << VIDEOS
+        << " videos (written in " << std::setprecision(1) << secondsSince(begin) << " s)\n" << std::defaultfloat;
+
+    // the verifier as shipped
+    Config saved = gonfig;
+    gonfig.output_path = root + "output/";
+    gonfig.verified_path = root + "verified/";
+    gonfig.tobii_sampling_rate = static_cast<int>(RATE_HZ);
+    gonfig.verify_rebuild = true;
+
+    std::ostringstream verifier_log;
+    TaskPool pool(0);
+    TobiiVerifier verifier;
+    begin = BenchClock::now();
+    bool verified = verifier.verify(pool, verifier_log);
+    double indexed_seconds = secondsSince(begin);
+    gonfig = saved;
+
+    log << "  TobiiVerifier, one pass: " << std::fixed << std::setprecision(2) << indexed_seconds << " s ("
+        << file_gb / indexed_seconds << " GB/s)" << std::defaultfloat << (verified ? "" : ", verify failed") << "\n";
+
+    std::map<std::string, std::pair<int, int>> counts;  // video -> total, failed
+    {
+        std::ifstream result(root + "verified/tobii_verify_result.csv");
+        std::string line;
+        std::getline(result, line);
+        while (std::getline(result, line)) {
+            std::vector<std::string> fields;
+            std::istringstream iss(line);
+            std::string field;
+            while (std::getline(iss, field, ',')) fields.push_back(field);
+            if (fields.size() == 6) counts[fields[0]] = {std::stoi(fields[2]), std::stoi(fields[5])};
+        }
+    }
+
+    // the per-video rescan, as many videos as the time budget allows
+    int rescanned = 0;
+    bool same = true;
+    begin = BenchClock::now();
+    while (rescanned < VIDEOS && (rescanned == 0 || secondsSince(begin) < bench_options.seconds)) {
+        int total = 0;
+        int failed = 0;
+        rescanCsvForVideo(csv_path, windows[rescanned].first, windows[rescanned].second, total, failed);
+
+        auto found = counts.find("VIDEO_INDEX_" + std::to_string(rescanned + 1));
+        same = same && found != counts.end() && found->second == std::make_pair(total, failed);
+        rescanned++;
+    }
+    double per_video = secondsSince(begin) / rescanned;
+
+    log << "  rescan per video: " << std::fixed << std::setprecision(2) << per_video << " s each (" << rescanned << " timed), "
+        << per_video * VIDEOS << " s for " << VIDEOS << " videos (x" << std::setprecision(1) << per_video * VIDEOS / indexed_seconds << ")"
+        << std::defaultfloat << "; counts " << (same ? "match" : "DIFFER") << "\n";
+
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+}
+
+
+/**
+ * @brief CSV read throughput in GB/s, getline + istringstream vs CsvScanner
+ *
+ * A --bench_session_mb MB gaze CSV is read once to warm the page cache,
+ * then: counting rows (getline vs countRows), and parsing the columns the
+ * verifier needs, frame_timestamp and both gaze validities (every field
+ * split and stod vs select + from_chars). Both parses must agree.
+ */
+
+void benchCsvScan(std::ostream& log) {
+    std::filesystem::create_directories(bench_options.dir);
+    const std::string csv_path = bench_options.dir + "/csv_scan.csv";
+    const std::uint64_t rows = writeBenchGazeCsv(csv_path, bench_options.session_mb << 20, 1200.0, 1.7e12);
+    const double file_gb = std::filesystem::file_size(csv_path) / 1e9;
+
+    auto report = [&](const char* label, double seconds) {
+        log << "  " << std::left << std::setw(34) << label << std::right << std::fixed << std::setprecision(2)
+            << std::setw(6) << file_gb / seconds << " GB/s (" << seconds << " s)\n" << std::defaultfloat;
+    };
+
+    // count rows
+    std::uint64_t lines = 0;
+    std::uint64_t counted = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        auto begin = BenchClock::now();
+        std::ifstream file(csv_path);
+        std::string line;
+        lines = 0;
+        while (std::getline(file, line)) lines++;
+        if (pass) report("rows, getline", secondsSince(begin));
+    }
+    {
+        auto begin = BenchClock::now();
+        CsvScanner scanner;
+        scanner.open(csv_path);
+        counted = scanner.countRows();
+        report("rows, CsvScanner::countRows", secondsSince(begin));
+    }
+
+    // parse frame_timestamp and the two gaze validities
+    double sum[2] = {0.0, 0.0};
+    std::uint64_t lost[2] = {0, 0};
+    {
+        auto begin = BenchClock::now();
+        std::ifstream file(csv_path);
+        std::string line;
+        std::getline(file, line);
+        while (std::getline(file, line)) {
+            std::istringstream iss(line);
+            std::vector<std::string> fields;
+            std::string field;
+            while (std::getline(iss, field, ',')) fields.push_back(field);
+            if (fields.size() < 20) continue;
+
+            sum[0] += std::stod(fields[1]);
+            if (fields[8] != "1" && fields[19] != "1") lost[0]++;
+        }
+        report("3 columns, istringstream + stod", secondsSince(begin));
+    }
+    {
+        auto begin = BenchClock::now();
+        CsvScanner scanner;
+        scanner.open(csv_path);
+        scanner.header();
+        scanner.select({1, 8, 19});
+        while (scanner.next()) {
+            if (!scanner.complete()) continue;
+
+            double frame_timestamp = 0.0;
+            if (!CsvScanner::parse(scanner.field(0), frame_timestamp)) continue;
+            sum[1] += frame_timestamp;
+            if (scanner.field(1) != "1" && scanner.field(2) != "1") lost[1]++;
+        }
+        report("3 columns, CsvScanner + from_chars", secondsSince(begin));
+    }
+
+    bool same = lines == rows + 1 && counted == lines && sum[0] == sum[1] && lost[0] == lost[1];
+    log << "  " << rows << " rows, " << lost[1] << " with both eyes lost; results " << (same ? "match" : "DIFFER") << "\n";
+
+    std::error_code ec;
+    std::filesystem::remove(csv_path, ec);
+}
+
+
+/**
+ * @main
+ * Benchmarks of the recording and verification hot paths, against the
+ * code they replaced where that fits in a few lines. No devices needed.
+ *
+ *   bench.exe [name ...] [--bench_seconds 5] [--bench_dir <dir>] [--bench_session_mb 256]
+ *
+ * Runs every benchmark, or only the named ones, and prints the numbers.
+ */
+
+struct Bench {
+    const char* name;
+    void (*run)(std::ostream& log);
+};
+
+int main(int argc, char* argv[]) {
+    gonfig = Config::parseArgs(argc, argv);
+
+    const std::vector<Bench> benches = {
+        {"wake_latency", &benchWakeLatency},
+        {"bulk_dequeue", &benchBulkDequeue},
+        {"spsc_ring", &benchSpscRing},
+        {"csv_format", &benchCsvFormat},
+        {"slow_writer", &benchSlowWriter},
+        {"frame_pool", &benchFramePool},
+        {"gaze_copy", &benchGazeCopy},
+        {"session_verify", &benchSessionVerify},
+        {"csv_scan", &benchCsvScan},
+    };
+
+    bench_options.dir = (std::filesystem::temp_directory_path() / "syncorder_bench").generic_string();
+
+    std::vector<std::string> wanted;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--bench_seconds" && i + 1 < argc) bench_options.seconds = std::stod(argv[++i]);
+        else if (arg == "--bench_dir" && i + 1 < argc) bench_options.dir = argv[++i];
+        else if (arg == "--bench_session_mb" && i + 1 < argc) bench_options.session_mb = std::stoul(argv[++i]);
+        else if (arg.rfind("--", 0) == 0) ++i;  // a gonfig flag and its value
+        else wanted.push_back(arg);
+    }
+
+    std::cout << "[bench] " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    for (const auto& bench : benches) {
+        bool selected = wanted.empty();
+        for (const auto& name : wanted) selected = selected || (name == bench.name);
+        if (!selected) continue;
+
+        std::cout << "[bench] " << bench.name << "\n";
+        bench.run(std::cout);
+    }
+
+    return 0;
+}
@@ -11,8 +11,10 @@
 #include <string>
 #include <map>
 #include <filesystem>
+#include <sstream>
 
 // local
+#include <syncorder/core/task_pool.h>
 #include <syncorder/devices/common/manager_base.h>
 #include <syncorder/gonfig/gonfig.h>
 #include <syncorder/error/exception.h>
@@ -104,13 +106,10 @@ public:
     bool executeCheck() {
         std::cout << "[syncorder] Starting check phase for flat structure at: " << gonfig.output_path << "\n";
 
-        for (auto& manager : managers_) {
-            try{
-                manager->check();
-            } catch (const std::exception& e) {
-                std::cout << "[" << manager->__name__() << "] Check error: " << e.what() << "\n";
-            }
-        }
+        TaskPool pool(TaskPool::threadsFor(gonfig.verify_threads) - 1);
+        executeReview(pool, "Check", [](BManager& manager, TaskPool&, std::ostream& log) {
+            manager.check(log);
+        });
 
         std::cout << "[syncorder] Check phase completed\n";
         return true;
@@ -119,13 +118,10 @@ public:
     bool executeVerify() {
         std::cout << "[syncorder] Starting verify phase for session structure at: " << gonfig.output_path << "\n";
 
-        for (auto& manager : managers_) {
-            try{
-                manager->verify();
-            } catch (const std::exception& e) {
-                std::cout << "[" << manager->__name__() << "] Verify error: " << e.what() << "\n";
-            }
-        }
+        TaskPool pool(TaskPool::threadsFor(gonfig.verify_threads) - 1);
+        executeReview(pool, "Verify", [](BManager& manager, TaskPool& pool, std::ostream& log) {
+            manager.verify(pool, log);
+        });
 
         std::cout << "[syncorder] Verify phase completed\n";
         return true;
@@ -190,6 +186,37 @@ private:
         return all_success;
     }
     
+    // one pool task per manager; each logs to its own buffer, printed in registration order
+    template<typename ReviewFunc>
+    void executeReview(TaskPool& pool, const std::string& stage_name, ReviewFunc func) {
+        if (pool.workers() == 0) {
+            for (auto& manager : managers_) {
+                try {
+                    func(*manager, pool, std::cout);
+                } catch (const std::exception& e) {
+                    std::cout << "[" << manager->__name__() << "] " << stage_name << " error: " << e.what() << "\n";
+                }
+            }
+            return;
+        }
+
+        std::vector<std::ostringstream> logs(managers_.size());
+        TaskPool::Group group;
+
+        for (std::size_t i = 0; i < managers_.size(); ++i) {
+            pool.submit(group, [this, i, &logs, &func, &stage_name, &pool]() {
+                try {
+                    func(*managers_[i], pool, logs[i]);
+                } catch (const std::exception& e) {
+                    logs[i] << "[" << managers_[i]->__name__() << "] " << stage_name << " error: " << e.what() << "\n";
+                }
+            });
+        }
+        pool.wait(group);
+
+        for (auto& log : logs) std::cout << log.str();
+    }
+
     template<typename T>
     bool waitForAllFutures(std::vector<std::future<T>>& futures, std::chrono::milliseconds timeout) {
         auto deadline = std::chrono::steady_clock::now() + timeout;
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @class TaskPool
+ * Work-stealing pool for coarse tasks (files, sessions, devices).
+ *
+ * Every worker owns a deque: it pushes and pops its own tasks at the back
+ * and steals from the front of the others when it runs dry. Tasks belong to
+ * a Group; wait(group) runs queued tasks on the calling thread until the
+ * group is done, so a task may submit and wait for sub-tasks without
+ * blocking a worker. With zero workers wait() runs everything inline, in
+ * submission order.
+ *
+ * The first exception thrown by a task of a group is rethrown by wait().
+ */
+
+class TaskPool {
+public:
+    class Group {
+    private:
+        friend class TaskPool;
+
+        std::atomic<std::size_t> pending_{0};
+        std::mutex error_mutex_;
+        std::exception_ptr error_;
+    };
+
+private:
+    struct Task {
+        std::function<void()> run;
+        Group* group = nullptr;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;  // [0, workers): workers, last: external submitters
+    std::vector<std::thread> threads_;
+
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+
+    static inline thread_local TaskPool* current_pool_ = nullptr;
+    static inline thread_local std::size_t current_queue_ = 0;
+
+public:
+    // workers besides the threads that wait(); 0 runs every task inline
+    explicit TaskPool(std::size_t workers) {
+        for (std::size_t i = 0; i <= workers; ++i) queues_.push_back(std::make_unique<Queue>());
+        for (std::size_t i = 0; i < workers; ++i) threads_.emplace_back([this, i]() { _work(i); });
+    }
+
+    ~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_.store(true);
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) thread.join();
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // total threads a wait() can count on: the workers plus the waiter
+    static std::size_t threadsFor(int configured) {
+        if (configured > 0) return static_cast<std::size_t>(configured);
+        std::size_t hardware = std::thread::hardware_concurrency();
+        return hardware ? hardware : 1;
+    }
+
+public:
+    std::size_t workers() const { return threads_.size(); }
+
+    template<typename F>
+    void submit(Group& group, F&& task) {
+        group.pending_.fetch_add(1, std::memory_order_relaxed);
+        queued_.fetch_add(1, std::memory_order_relaxed);  // before the push: a taker never drives it below zero
+
+        Queue& queue = *queues_[(current_pool_ == this) ? current_queue_ : queues_.size() - 1];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(Task{std::function<void()>(std::forward<F>(task)), &group});
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        wake_.notify_all();
+    }
+
+    void wait(Group& group) {
+        std::size_t home = (current_pool_ == this) ? current_queue_ : queues_.size() - 1;
+
+        while (group.pending_.load(std::memory_order_acquire) > 0) {
+            Task task;
+            if (_take(home, task)) {
+                _run(task);
+                continue;
+            }
+
+            // everything left is running on other threads
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [&]() {
+                return group.pending_.load(std::memory_order_acquire) == 0
+                    || queued_.load(std::memory_order_acquire) > 0;
+            });
+        }
+
+        std::lock_guard<std::mutex> lock(group.error_mutex_);
+        if (group.error_) {
+            std::exception_ptr error = group.error_;
+            group.error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void _work(std::size_t index) {
+        current_pool_ = this;
+        current_queue_ = index;
+
+        while (true) {
+            Task task;
+            if (_take(index, task)) {
+                _run(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [this]() {
+                return stopping_.load() || queued_.load(std::memory_order_acquire) > 0;
+            });
+            if (stopping_.load() && queued_.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+
+    // a worker's own queue from the back (latest, cache-warm), anything else from the front
+    bool _take(std::size_t home, Task& task) {
+        if (queued_.load(std::memory_order_acquire) == 0) return false;
+
+        {
+            Queue& queue = *queues_[home];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                bool own = home < threads_.size();
+                task = std::move(own ? queue.tasks.back() : queue.tasks.front());
+                if (own) queue.tasks.pop_back(); else queue.tasks.pop_front();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        for (std::size_t n = 1; n < queues_.size(); ++n) {
+            Queue& queue = *queues_[(home + n) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void _run(Task& task) {
+        try {
+            task.run();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(task.group->error_mutex_);
+            if (!task.group->error_) task.group->error_ = std::current_exception();
+        }
+
+        if (task.group->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            wake_.notify_all();
+        }
+    }
+};
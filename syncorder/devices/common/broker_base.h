@@ -2,10 +2,16 @@
 
 #include <thread>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 // installed
 #include <librealsense2/rs.hpp> // *timestamp 변환을 위한 include
 
+// local
+#include <syncorder/devices/common/buffer_base.h>
+#include <syncorder/monitoring/histogram.h>
+
 
 /**
  * @class Helper
@@ -18,16 +24,16 @@
 
 class BBroker {
 protected:
-    // buffer
-    void* buffer_;
-    void* dequeue_;
-
     // flag
     std::atomic<bool> running_;
     std::atomic<int> processed_count_;
 
     std::thread processing_thread_;
 
+    // wakes a broker pausing between batches
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+
 public:
     BBroker() 
     : 
@@ -38,11 +44,6 @@ public:
     virtual ~BBroker() { stop(); }
 
 public:
-    void setup(void* buffer, void* dequeue) {
-        buffer_ = buffer;
-        dequeue_ = dequeue;
-    }
-
     void start() {
         // flag
         running_ = true;
@@ -53,7 +54,11 @@ public:
 
     void stop() {
         // flag
-        running_ = false;
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex_);
+            running_ = false;
+        }
+        stop_cv_.notify_all();
 
         // thread
         if (processing_thread_.joinable()) processing_thread_.join();
@@ -62,35 +67,112 @@ public:
 protected:
     virtual void _broker() = 0;
 
+    // runs once on the broker thread after stop(), before it exits
+    virtual void _drain() {}
+
+    // sleeps until deadline; returns early on stop() so the drain starts at once
+    void _pauseUntil(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(stop_mutex_);
+        stop_cv_.wait_until(lock, deadline, [this] { return !running_; });
+    }
+
 private:
     void _loop() {
         while (running_) _broker();
+        _drain();
     }
 };
 
 template<typename DataType>
 class TBBroker : public BBroker {
+protected:
+    static constexpr std::size_t BATCH_SIZE = 256;
+
+    // buffer
+    BQueue<DataType>* queue_{nullptr};
+
+    // telemetry, recorded by the broker thread only
+    Histogram batch_size_;
+    Histogram batch_us_;
+
+    // minimum time between batches, so high-rate streams are written in batches, not per sample
+    std::chrono::microseconds batch_interval_{0};
+
+public:
+    void setup(BQueue<DataType>* queue) {
+        queue_ = queue;
+    }
+
+    // let samples accumulate for up to max_latency, but never more than half a batch at rate_hz
+    void setBatchInterval(double rate_hz, std::chrono::milliseconds max_latency) {
+        std::chrono::microseconds interval = max_latency;
+        if (rate_hz > 0.0) {
+            auto half_batch = std::chrono::microseconds(static_cast<long long>(BATCH_SIZE / 2 * 1e6 / rate_hz));
+            if (half_batch < interval) interval = half_batch;
+        }
+        batch_interval_ = (interval.count() > 0) ? interval : std::chrono::microseconds(0);
+    }
+
+    // items per _processBatch() call
+    const Histogram& batchSizeHistogram() const noexcept {
+        return batch_size_;
+    }
+
+    // time spent formatting and writing one batch, in microseconds
+    const Histogram& batchTimeHistogram() const noexcept {
+        return batch_us_;
+    }
+
 protected:
     void _broker() override {
-        if (!buffer_ || !dequeue_) {
+        if (!queue_) {
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
             return;
         }
 
-        typedef void* (*DequeueFunc)(void*);
-        auto dequeue_func = reinterpret_cast<DequeueFunc>(dequeue_);
-        void* raw_data = dequeue_func(buffer_);
-        
-        if (raw_data != nullptr) {
-            processed_count_++;
-            
-            std::unique_ptr<DataType> data(static_cast<DataType*>(raw_data));
-            _process(*data);
+        auto begin = std::chrono::steady_clock::now();
+        std::size_t count = _processAvailable();
+
+        if (count > 0) {
+            // a full batch means we are behind: go straight on
+            if (count < BATCH_SIZE && batch_interval_.count() > 0) {
+                _pauseUntil(begin + batch_interval_);
+            }
         } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            // spin briefly, then park until the producer enqueues (bounded so stop() is observed)
+            queue_->_wait(std::chrono::milliseconds(100));
         }
     }
 
+    // the buffer is gated before stop(): write out the ring, then the spill, until both are empty
+    void _drain() override {
+        if (!queue_) return;
+        while (_processAvailable() > 0) {}
+    }
+
+    // one batch of whatever is available, processed in place; returns its size
+    std::size_t _processAvailable() {
+        DataType* first = nullptr;
+        std::size_t count = queue_->_frontBulk(first, BATCH_SIZE);
+        if (count == 0) return 0;
+
+        processed_count_ += static_cast<int>(count);
+
+        auto begin = std::chrono::steady_clock::now();
+        _processBatch(first, count);
+        auto elapsed = std::chrono::steady_clock::now() - begin;
+
+        queue_->_popBulk(count);
+
+        batch_size_.record(count);
+        batch_us_.record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        return count;
+    }
+
 protected:
     virtual void _process(const DataType& data) = 0;
-};
\ No newline at end of file
+
+    virtual void _processBatch(const DataType* data, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) _process(data[i]);
+    }
+};
@@ -2,57 +2,424 @@
 
 #include <chrono>
 #include <array>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 #include <atomic>
 #include <optional>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <type_traits>
+#include <filesystem>
+#include <string>
+#include <immintrin.h>
 
+// local
+#include <syncorder/io/mapped_file.h>
+#include <syncorder/monitoring/histogram.h>
+
+
+/**
+ * @enum OverflowPolicy
+ * What enqueue() does when the ring is full.
+ */
+
+enum class OverflowPolicy {
+    DropNewest,     // reject the incoming item
+    DropOldest,     // keep the newest 7/8 of capacity; the consumer evicts the oldest
+    Block,          // wait up to block_timeout for space, then drop the incoming item
+    Spill,          // append to a memory-mapped overflow file drained after the ring
+};
+
+inline OverflowPolicy parseOverflowPolicy(const std::string& name) {
+    if (name == "drop_oldest") return OverflowPolicy::DropOldest;
+    if (name == "block") return OverflowPolicy::Block;
+    if (name == "spill") return OverflowPolicy::Spill;
+    return OverflowPolicy::DropNewest;
+}
+
+inline const char* overflowPolicyName(OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::DropOldest: return "drop_oldest";
+        case OverflowPolicy::Block: return "block";
+        case OverflowPolicy::Spill: return "spill";
+        default: return "drop_newest";
+    }
+}
+
+struct OverflowOptions {
+    std::chrono::milliseconds block_timeout{5};
+    std::string spill_path;
+    std::size_t spill_capacity{1 << 16};
+};
+
+struct OverflowStats {
+    std::size_t dropped_newest{0};
+    std::size_t dropped_oldest{0};
+    std::size_t blocked{0};
+    std::size_t spilled{0};
+    std::size_t discarded{0};   // still queued when the consumer stopped
+
+    bool any() const {
+        return dropped_newest || dropped_oldest || blocked || spilled || discarded;
+    }
+};
+
+
+/**
+ * @class Base Queue
+ * Typed consumer-side view of a buffer. Slots are handed out in place.
+ */
+
+template <typename T>
+class BQueue {
+public:
+    virtual ~BQueue() = default;
+
+public:
+    virtual T* _front() noexcept = 0;
+    virtual void _pop() noexcept = 0;
+    virtual std::size_t _frontBulk(T*& first, std::size_t max) noexcept = 0;
+    virtual void _popBulk(std::size_t count) noexcept = 0;
+    virtual bool _wait(std::chrono::milliseconds timeout) noexcept = 0;
+};
+
+
+/**
+ * Capacity for N in BBuffer<T, N> when the size is only known at runtime
+ * (set with setCapacity() before start()).
+ */
+constexpr std::size_t DYNAMIC_CAPACITY = 0;
+
+/**
+ * Ring size for a stream: rate * headroom, rounded up to a power of two.
+ */
+inline std::size_t ringCapacity(double rate_hz, double headroom_seconds, std::size_t min_capacity = 64) {
+    double wanted = std::ceil(rate_hz * headroom_seconds);
+
+    std::size_t capacity = 1;
+    while (capacity < min_capacity || static_cast<double>(capacity) < wanted) capacity <<= 1;
+    return capacity;
+}
+
+
+/**
+ * @class Base Buffer
+ */
 
 template <typename T, std::size_t N>
-class BBuffer {
+class BBuffer : public BQueue<T> {
+    static_assert((N & (N - 1)) == 0, "BBuffer capacity must be a power of two");
+
 protected:
-    std::atomic<std::size_t> m_head;
-    std::array<T, N> m_buff;
-    std::atomic<std::size_t> m_tail;
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    using Storage = std::conditional_t<N == DYNAMIC_CAPACITY, std::vector<T>, std::array<T, N>>;
+    using StampStorage = std::conditional_t<N == DYNAMIC_CAPACITY, std::vector<std::int64_t>, std::array<std::int64_t, N>>;
 
+    // consumer line: head plus the consumer's cached copy of tail
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_head;
+    std::size_t m_tail_cache;
+
+    // producer line: tail plus the producer's cached copy of head, and the gate it reads
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_tail;
+    std::size_t m_head_cache;
     std::atomic<bool> gate_{true};
 
+    alignas(CACHE_LINE) Storage m_buff;
+    StampStorage m_stamp;   // enqueue time (steady ns) per slot, written by the producer
+    std::size_t capacity_{N};
+
+    // wait
+    static constexpr int SPIN_COUNT = 256;
+    static constexpr int YIELD_COUNT = 16;
+
+    alignas(CACHE_LINE) std::atomic<bool> waiting_{false};
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    // overflow
+    static constexpr bool SPILLABLE = std::is_trivially_copyable_v<T>;
+
+    OverflowPolicy policy_{OverflowPolicy::DropNewest};
+    std::chrono::milliseconds block_timeout_{5};
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_evict{0};
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> dropped_newest_{0};
+    std::atomic<std::size_t> blocked_{0};
+    std::atomic<std::size_t> spilled_{0};
+    std::atomic<std::size_t> dropped_oldest_{0};
+    std::atomic<std::size_t> discarded_{0};
+
+    // telemetry, recorded by the consumer only
+    Histogram occupancy_;
+    Histogram delay_us_;
+
+    // spill (consumer drains it only once the ring is empty, so order is kept)
+    MappedFile spill_file_;
+    std::string spill_path_;
+    T* spill_{nullptr};
+    std::vector<std::int64_t> spill_stamp_;
+    std::size_t spill_mask_{0};
+    bool from_spill_{false};
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> spill_head_{0};
+    alignas(CACHE_LINE) std::atomic<std::size_t> spill_tail_{0};
+
 public:
-    constexpr BBuffer() noexcept
+    BBuffer() noexcept
     : 
         m_head(0), 
+        m_tail_cache(0),
         m_tail(0),
+        m_head_cache(0),
         gate_(true)
     {}
-    virtual ~BBuffer() = default;
+    virtual ~BBuffer() {
+        if (!spill_path_.empty()) {
+            spill_file_.close();
+
+            std::error_code ec;
+            std::filesystem::remove(spill_path_, ec);
+        }
+    }
 
 public:
+    /**
+     * Select the overflow policy. Call before start(). Spill needs a
+     * trivially copyable T and a writable path (its directory is created
+     * here, since the broker only opens the session folder later); on
+     * failure the buffer falls back to DropNewest and returns false.
+     */
+    bool setOverflowPolicy(OverflowPolicy policy, const OverflowOptions& options = OverflowOptions()) {
+        policy_ = policy;
+        block_timeout_ = options.block_timeout;
+
+        if (policy != OverflowPolicy::Spill) return true;
+
+        if constexpr (SPILLABLE) {
+            std::size_t capacity = 1;
+            while (capacity < options.spill_capacity) capacity <<= 1;
+
+            if (!options.spill_path.empty()) {
+                std::error_code ec;
+                std::filesystem::path parent = std::filesystem::path(options.spill_path).parent_path();
+                if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+            }
+
+            if (!options.spill_path.empty() && spill_file_.create(options.spill_path, capacity * sizeof(T))) {
+                spill_path_ = options.spill_path;
+                spill_ = reinterpret_cast<T*>(spill_file_.data());
+                spill_stamp_.assign(capacity, 0);
+                spill_mask_ = capacity - 1;
+                return true;
+            }
+        }
+
+        policy_ = OverflowPolicy::DropNewest;
+        return false;
+    }
+
+    OverflowPolicy overflowPolicy() const noexcept {
+        return policy_;
+    }
+
+    OverflowStats overflowStats() const noexcept {
+        OverflowStats stats;
+        stats.dropped_newest = dropped_newest_.load(std::memory_order_relaxed);
+        stats.dropped_oldest = dropped_oldest_.load(std::memory_order_relaxed);
+        stats.blocked = blocked_.load(std::memory_order_relaxed);
+        stats.spilled = spilled_.load(std::memory_order_relaxed);
+        stats.discarded = discarded_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /**
+     * Size the ring of a DYNAMIC_CAPACITY buffer (rounded up to a power of
+     * two). Call before start().
+     */
+    void setCapacity(std::size_t capacity) {
+        static_assert(N == DYNAMIC_CAPACITY, "setCapacity() needs BBuffer<T, DYNAMIC_CAPACITY>");
+
+        std::size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+
+        // clear + resize rather than assign: items may be move-only
+        m_buff.clear();
+        m_buff.resize(rounded);
+        m_stamp.assign(rounded, 0);
+        capacity_ = rounded;
+    }
+
+    std::size_t capacity() const noexcept {
+        return _capacity();
+    }
+
+    // highest ring occupancy seen by the consumer
+    std::size_t highWatermark() const noexcept {
+        return static_cast<std::size_t>(occupancy_.maximum());
+    }
+
+    // ring occupancy each time the consumer looked
+    const Histogram& occupancyHistogram() const noexcept {
+        return occupancy_;
+    }
+
+    // time between enqueue() and the consumer releasing the item, in microseconds
+    const Histogram& delayHistogram() const noexcept {
+        return delay_us_;
+    }
+
     bool enqueue(T val) noexcept {
         // gate
         if (gate_.load(std::memory_order_acquire)) return false;
 
+        // keep order: once items are spilled, later items queue behind them
+        if constexpr (SPILLABLE) {
+            if (spill_ && !_spillEmpty()) return _spill(val);
+        }
+
         // run
         std::size_t current_tail = m_tail.load(std::memory_order_relaxed);
-        if (current_tail - m_head.load(std::memory_order_acquire) < N) {
-            m_buff[current_tail % N] = std::move(val);
-            m_tail.store(current_tail + 1, std::memory_order_release);
-            return true;
+        std::size_t capacity = _capacity();
+        std::size_t limit = (policy_ == OverflowPolicy::DropOldest) ? capacity - capacity / 8 : capacity;
+
+        if (current_tail - m_head_cache >= limit) {
+            // only touch the consumer's line when the cached head says we are full
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (current_tail - m_head_cache >= limit) {
+                if constexpr (SPILLABLE) {
+                    if (spill_) return _spill(val);
+                }
+                if (!_overflow(current_tail)) return false;
+            }
         }
-        
-        onOverflow();
-        return false;
+
+        m_buff[current_tail & _mask()] = std::move(val);
+        m_stamp[current_tail & _mask()] = _now();
+        m_tail.store(current_tail + 1, std::memory_order_release);
+
+        _notify();
+        return true;
     }
     
     std::optional<T> _dequeue() noexcept {
-        std::size_t current_tail = m_tail.load(std::memory_order_acquire);
+        T* item = _front();
+        if (item == nullptr) return std::nullopt;
+
+        std::optional<T> value(std::move(*item));
+        _pop();
+        return value;
+    }
+
+    /**
+     * Peek the oldest item without moving it out. The slot stays owned by
+     * the consumer until _pop(), so the producer cannot overwrite it.
+     */
+    T* _front() noexcept override {
+        T* first = nullptr;
+        return _frontBulk(first, 1) ? first : nullptr;
+    }
+
+    void _pop() noexcept override {
+        _popBulk(1);
+    }
+
+    /**
+     * Peek up to max items at once. Returns the length of the contiguous run
+     * starting at head (a batch never spans the wrap point), with one acquire
+     * load for the whole run. Spilled items are handed out once the ring is empty.
+     */
+    std::size_t _frontBulk(T*& first, std::size_t max) noexcept override {
+        _evict();
+
+        std::size_t current_head = m_head.load(std::memory_order_relaxed);
+        if (m_tail_cache - current_head < max) {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+        }
+        std::size_t available = m_tail_cache - current_head;
+
+        occupancy_.record(available);
+
+        if (available > 0) {
+            std::size_t offset = current_head & _mask();
+            std::size_t count = (std::min)({available, max, _capacity() - offset});
+
+            from_spill_ = false;
+            first = &m_buff[offset];
+            return count;
+        }
+
+        if constexpr (SPILLABLE) {
+            if (spill_) return _frontSpill(first, max);
+        }
+
+        return 0;
+    }
+
+    void _popBulk(std::size_t count) noexcept override {
+        std::int64_t now = _now();
+
+        if (from_spill_) {
+            std::size_t current_head = spill_head_.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < count; ++i) {
+                _recordDelay(now, spill_stamp_[(current_head + i) & spill_mask_]);
+            }
+
+            spill_head_.store(current_head + count, std::memory_order_release);
+            return;
+        }
+
         std::size_t current_head = m_head.load(std::memory_order_relaxed);
-        
-        if (current_head != current_tail) {
-            auto value = std::move(m_buff[current_head % N]);
-            m_head.store(current_head + 1, std::memory_order_release);
-            return std::optional<T>(std::move(value));
+        for (std::size_t i = 0; i < count; ++i) {
+            _recordDelay(now, m_stamp[(current_head + i) & _mask()]);
         }
-        
-        return std::nullopt;
+
+        // release handles (e.g. rs2::frame) now rather than when the slot is reused
+        if constexpr (!std::is_trivially_copyable_v<T>) {
+            for (std::size_t i = 0; i < count; ++i) {
+                m_buff[(current_head + i) & _mask()] = T();
+            }
+        }
+
+        m_head.store(current_head + count, std::memory_order_release);
+    }
+
+    /**
+     * Block until an item is available or the timeout expires.
+     * Spins briefly, then yields, then parks until enqueue() signals.
+     */
+    bool _wait(std::chrono::milliseconds timeout) noexcept override {
+        for (int i = 0; i < SPIN_COUNT; ++i) {
+            if (!_empty()) return true;
+            _mm_pause();
+        }
+
+        for (int i = 0; i < YIELD_COUNT; ++i) {
+            if (!_empty()) return true;
+            std::this_thread::yield();
+        }
+
+        // park
+        waiting_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool ready;
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            ready = wait_cv_.wait_for(lock, timeout, [this] { return !_empty(); });
+        }
+
+        waiting_.store(false, std::memory_order_relaxed);
+        return ready;
+    }
+
+    void _wake() noexcept {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cv_.notify_all();
     }
 
     void start() {
@@ -61,12 +428,170 @@ public:
 
     void stop() {
         gate_.store(true, std::memory_order_release);
+        _wake();
     }
     
+    /**
+     * Drop whatever the consumer left behind (ring and spill) and count it
+     * as discarded. Call after stop() once the consumer thread has drained
+     * and exited; normally there is nothing left.
+     */
+    std::size_t discardRemaining() noexcept {
+        _evict();
+
+        std::size_t current_head = m_head.load(std::memory_order_relaxed);
+        std::size_t current_tail = m_tail.load(std::memory_order_acquire);
+        std::size_t count = current_tail - current_head;
+
+        if constexpr (!std::is_trivially_copyable_v<T>) {
+            for (std::size_t i = current_head; i != current_tail; ++i) m_buff[i & _mask()] = T();
+        }
+        m_head.store(current_tail, std::memory_order_release);
+        m_tail_cache = current_tail;
+
+        std::size_t spill_tail = spill_tail_.load(std::memory_order_acquire);
+        count += spill_tail - spill_head_.load(std::memory_order_relaxed);
+        spill_head_.store(spill_tail, std::memory_order_release);
+
+        discarded_.fetch_add(count, std::memory_order_relaxed);
+        return count;
+    }
+
     std::size_t size() const noexcept {
-        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+        std::size_t count = m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+        return count + spill_tail_.load(std::memory_order_acquire) - spill_head_.load(std::memory_order_acquire);
     }
 
 protected:
-    virtual void onOverflow() noexcept = 0;
+    // optional hook, called on the producer thread for every dropped incoming item
+    virtual void onOverflow() noexcept {}
+
+private:
+    std::size_t _capacity() const noexcept {
+        if constexpr (N == DYNAMIC_CAPACITY) return capacity_;
+        else return N;
+    }
+
+    std::size_t _mask() const noexcept {
+        return _capacity() - 1;
+    }
+
+    static std::int64_t _now() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void _recordDelay(std::int64_t now, std::int64_t stamp) noexcept {
+        delay_us_.record(now > stamp ? static_cast<std::uint64_t>(now - stamp) / 1000 : 0);
+    }
+
+    // consumer side: refresh the cached tail only when it shows nothing left
+    std::size_t _available(std::size_t current_head) noexcept {
+        if (m_tail_cache == current_head) {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+        }
+        return m_tail_cache - current_head;
+    }
+
+    bool _empty() noexcept {
+        if (_available(m_head.load(std::memory_order_relaxed)) > 0) return false;
+        return spill_tail_.load(std::memory_order_acquire) == spill_head_.load(std::memory_order_relaxed);
+    }
+
+    // producer side: decide whether the slot at current_tail may still be written
+    bool _overflow(std::size_t current_tail) noexcept {
+        switch (policy_) {
+            case OverflowPolicy::DropOldest:
+                // write into the slack and have the consumer evict the oldest item
+                if (current_tail - m_head_cache < _capacity()) {
+                    m_evict.fetch_add(1, std::memory_order_release);
+                    return true;
+                }
+                break;
+
+            case OverflowPolicy::Block: {
+                blocked_.fetch_add(1, std::memory_order_relaxed);
+
+                auto deadline = std::chrono::steady_clock::now() + block_timeout_;
+                while (!gate_.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+
+                    m_head_cache = m_head.load(std::memory_order_acquire);
+                    if (current_tail - m_head_cache < _capacity()) return true;
+                    if (std::chrono::steady_clock::now() >= deadline) break;
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        dropped_newest_.fetch_add(1, std::memory_order_relaxed);
+        onOverflow();
+        return false;
+    }
+
+    // consumer side: apply evictions requested by the producer under DropOldest
+    void _evict() noexcept {
+        if (m_evict.load(std::memory_order_relaxed) == 0) return;
+
+        std::size_t pending = m_evict.exchange(0, std::memory_order_acquire);
+        std::size_t current_head = m_head.load(std::memory_order_relaxed);
+
+        m_tail_cache = m_tail.load(std::memory_order_acquire);
+        std::size_t count = (std::min)(pending, m_tail_cache - current_head);
+
+        if constexpr (!std::is_trivially_copyable_v<T>) {
+            for (std::size_t i = 0; i < count; ++i) {
+                m_buff[(current_head + i) & _mask()] = T();
+            }
+        }
+
+        m_head.store(current_head + count, std::memory_order_release);
+        dropped_oldest_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    bool _spillEmpty() const noexcept {
+        return spill_tail_.load(std::memory_order_relaxed) == spill_head_.load(std::memory_order_acquire);
+    }
+
+    bool _spill(const T& val) noexcept {
+        std::size_t current_tail = spill_tail_.load(std::memory_order_relaxed);
+        if (current_tail - spill_head_.load(std::memory_order_acquire) > spill_mask_) {
+            dropped_newest_.fetch_add(1, std::memory_order_relaxed);
+            onOverflow();
+            return false;
+        }
+
+        spill_[current_tail & spill_mask_] = val;
+        spill_stamp_[current_tail & spill_mask_] = _now();
+        spill_tail_.store(current_tail + 1, std::memory_order_release);
+        spilled_.fetch_add(1, std::memory_order_relaxed);
+
+        _notify();
+        return true;
+    }
+
+    std::size_t _frontSpill(T*& first, std::size_t max) noexcept {
+        std::size_t current_head = spill_head_.load(std::memory_order_relaxed);
+        std::size_t available = spill_tail_.load(std::memory_order_acquire) - current_head;
+        if (available == 0) return 0;
+
+        std::size_t offset = current_head & spill_mask_;
+        std::size_t count = (std::min)({available, max, spill_mask_ + 1 - offset});
+
+        from_spill_ = true;
+        first = &spill_[offset];
+        return count;
+    }
+
+    void _notify() noexcept {
+        // pairs with the fence in _wait(): either the consumer sees the new tail, or we see waiting_
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!waiting_.load(std::memory_order_relaxed)) return;
+
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cv_.notify_one();
+    }
 };
\ No newline at end of file
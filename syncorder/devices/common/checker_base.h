@@ -14,11 +14,16 @@
 class BChecker {
 protected:
     bool result_{true};
+    std::ostream* log_{&std::cout};
 
 public:
     BChecker() = default;
     virtual ~BChecker() = default;
 
 public:
-    virtual bool check() = 0;
+    // messages go to log (std::cout when run serially)
+    virtual bool check(std::ostream& log) = 0;
+
+protected:
+    std::ostream& _log() { return *log_; }
 };
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @struct ClockFit
+ * Linear map between two microsecond clocks: y = y_ref + offset + skew * (x - x_ref).
+ */
+
+struct ClockFit {
+    std::int64_t x_ref = 0;
+    std::int64_t y_ref = 0;
+    double offset = 0.0;        // us at x_ref
+    double skew = 1.0;          // dy/dx
+    std::uint32_t points = 0;   // 0: no fit yet
+    double rtt_us = 0.0;        // worst round trip among the fitted points
+    double residual_us = 0.0;   // rms residual of the fit
+
+    bool valid() const { return points > 0; }
+
+    double map(std::int64_t x) const {
+        return static_cast<double>(y_ref) + offset + skew * static_cast<double>(x - x_ref);
+    }
+
+    double skewPpm() const { return (skew - 1.0) * 1e6; }
+};
+
+
+// outer(inner(x)) as one fit over inner's x; invalid unless both are
+inline ClockFit composeClock(const ClockFit& outer, const ClockFit& inner) {
+    ClockFit result;
+    if (!outer.valid() || !inner.valid()) return result;
+
+    result.x_ref = inner.x_ref;
+    result.y_ref = outer.y_ref;
+    result.offset = outer.offset + outer.skew * (static_cast<double>(inner.y_ref - outer.x_ref) + inner.offset);
+    result.skew = outer.skew * inner.skew;
+    result.points = (std::min)(outer.points, inner.points);
+    result.rtt_us = (std::max)(outer.rtt_us, inner.rtt_us);
+    result.residual_us = std::sqrt(outer.residual_us * outer.residual_us + inner.residual_us * inner.residual_us);
+    return result;
+}
+
+// fit.map(x[i]) / 1000 for n timestamps (us in, ms out); a default ClockFit is the identity
+inline void mapClockBatch(const ClockFit& fit, const std::int64_t* x, double* out_ms, std::size_t n) {
+    // y_ref + offset folded once; the loop is a plain multiply-add the compiler vectorizes
+    const std::int64_t x_ref = fit.x_ref;
+    const double base_ms = (static_cast<double>(fit.y_ref) + fit.offset) / 1000.0;
+    const double scale = fit.skew / 1000.0;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        out_ms[i] = base_ms + scale * static_cast<double>(x[i] - x_ref);
+    }
+}
+
+
+/**
+ * @class ClockEstimator
+ * Streaming fit of one clock against another from bracketed samples.
+ *
+ * Each sample is (x, y, rtt): a reading of clock y taken within a round
+ * trip of rtt around x. Of every GROUP consecutive samples only the one
+ * with the smallest round trip is kept (queueing delay only ever adds),
+ * and the last FIT_POINTS kept samples are fitted by least squares. The
+ * group in progress contributes its best sample so far, so the first
+ * sample already yields an offset-only fit.
+ *
+ * Single writer; publish the result through PublishedClock.
+ */
+
+class ClockEstimator {
+public:
+    static constexpr std::size_t GROUP = 4;
+    static constexpr std::size_t FIT_POINTS = 64;
+    static constexpr double MAX_SKEW_PPM = 1000.0;  // beyond any crystal: fall back to offset only
+
+private:
+    struct Point {
+        std::int64_t x;
+        std::int64_t y;
+        std::int64_t rtt;
+    };
+
+    std::array<Point, FIT_POINTS> points_{};
+    std::size_t next_ = 0;
+    std::size_t size_ = 0;
+
+    Point best_{};
+    std::size_t group_count_ = 0;
+
+    std::uint64_t samples_ = 0;
+
+public:
+    void add(std::int64_t x, std::int64_t y, std::int64_t rtt) {
+        if (rtt < 0) return;
+        samples_++;
+
+        if (group_count_ == 0 || rtt < best_.rtt) best_ = Point{x, y, rtt};
+        if (++group_count_ < GROUP) return;
+
+        points_[next_] = best_;
+        next_ = (next_ + 1) % FIT_POINTS;
+        if (size_ < FIT_POINTS) size_++;
+        group_count_ = 0;
+    }
+
+    std::uint64_t samples() const { return samples_; }
+
+    ClockFit fit() const {
+        ClockFit result;
+        std::size_t n = size_ + (group_count_ ? 1 : 0);
+        if (n == 0) return result;
+
+        // oldest kept point is the reference, so the sums stay small
+        const Point& ref = (size_ == FIT_POINTS) ? points_[next_] : (size_ ? points_[0] : best_);
+        result.x_ref = ref.x;
+        result.y_ref = ref.y;
+        result.points = static_cast<std::uint32_t>(n);
+
+        double sx = 0.0, sy = 0.0;
+        _each([&](const Point& p) {
+            sx += static_cast<double>(p.x - ref.x);
+            sy += static_cast<double>(p.y - ref.y);
+        });
+        double mx = sx / n;
+        double my = sy / n;
+
+        double sxx = 0.0, sxy = 0.0;
+        _each([&](const Point& p) {
+            double dx = static_cast<double>(p.x - ref.x) - mx;
+            double dy = static_cast<double>(p.y - ref.y) - my;
+            sxx += dx * dx;
+            sxy += dx * dy;
+        });
+
+        result.skew = (sxx > 0.0) ? sxy / sxx : 1.0;
+        if (std::fabs(result.skew - 1.0) * 1e6 > MAX_SKEW_PPM) result.skew = 1.0;
+        result.offset = my - result.skew * mx;
+
+        double sse = 0.0;
+        _each([&](const Point& p) {
+            double e = static_cast<double>(p.y - ref.y) - (result.offset + result.skew * static_cast<double>(p.x - ref.x));
+            sse += e * e;
+            if (p.rtt > result.rtt_us) result.rtt_us = static_cast<double>(p.rtt);
+        });
+        result.residual_us = std::sqrt(sse / n);
+
+        return result;
+    }
+
+private:
+    template<typename F>
+    void _each(F&& f) const {
+        for (std::size_t i = 0; i < size_; ++i) f(points_[i]);
+        if (group_count_) f(best_);
+    }
+};
+
+
+/**
+ * @class PublishedClock
+ * Latest ClockFit for any number of readers, seqlocked: the writer never
+ * waits and readers retry while an update is in flight.
+ */
+
+class PublishedClock {
+private:
+    std::atomic<std::uint64_t> sequence_{0};
+
+    std::atomic<std::int64_t> x_ref_{0};
+    std::atomic<std::int64_t> y_ref_{0};
+    std::atomic<double> offset_{0.0};
+    std::atomic<double> skew_{1.0};
+    std::atomic<std::uint32_t> points_{0};
+    std::atomic<double> rtt_us_{0.0};
+    std::atomic<double> residual_us_{0.0};
+
+public:
+    // single writer
+    void publish(const ClockFit& fit) {
+        std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);  // odd: being written
+        std::atomic_thread_fence(std::memory_order_release);
+
+        x_ref_.store(fit.x_ref, std::memory_order_relaxed);
+        y_ref_.store(fit.y_ref, std::memory_order_relaxed);
+        offset_.store(fit.offset, std::memory_order_relaxed);
+        skew_.store(fit.skew, std::memory_order_relaxed);
+        points_.store(fit.points, std::memory_order_relaxed);
+        rtt_us_.store(fit.rtt_us, std::memory_order_relaxed);
+        residual_us_.store(fit.residual_us, std::memory_order_relaxed);
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    ClockFit load() const {
+        ClockFit fit;
+        while (true) {
+            std::uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) continue;
+
+            fit.x_ref = x_ref_.load(std::memory_order_relaxed);
+            fit.y_ref = y_ref_.load(std::memory_order_relaxed);
+            fit.offset = offset_.load(std::memory_order_relaxed);
+            fit.skew = skew_.load(std::memory_order_relaxed);
+            fit.points = points_.load(std::memory_order_relaxed);
+            fit.rtt_us = rtt_us_.load(std::memory_order_relaxed);
+            fit.residual_us = residual_us_.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) return fit;
+        }
+    }
+};
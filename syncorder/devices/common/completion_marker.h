@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+
+/**
+ * @struct CompletionMarker
+ * "<file>.complete" next to a recording, written by the recorder once the
+ * file is closed cleanly. It holds the byte count at close, so a reader
+ * tells a finished file from one still being written (no marker yet) or
+ * cut short later (size mismatch) with one stat and a tiny read, instead
+ * of watching the file size over time.
+ *
+ * write() goes through a temp file and one rename, so a marker is either
+ * absent or whole.
+ */
+
+struct CompletionMarker {
+    enum class State {
+        Complete,   // marker matches the file
+        Missing,    // no marker: older recording, or the recorder did not stop cleanly
+        Mismatch,   // marker present but the file is not the size it was closed at
+    };
+
+    static constexpr const char* MAGIC = "syncorder_complete 1";
+    static constexpr const char* SUFFIX = ".complete";
+
+    static std::string pathFor(const std::string& file_path) {
+        return file_path + SUFFIX;
+    }
+
+    // call after file_path is closed; false if it is missing, empty or the marker could not be written
+    static bool write(const std::string& file_path) {
+        std::error_code ec;
+        std::uint64_t size = std::filesystem::file_size(file_path, ec);
+        if (ec || size == 0) return false;
+
+        std::string marker_path = pathFor(file_path);
+        std::string temp_path = marker_path + ".tmp";
+        {
+            std::ofstream marker(temp_path, std::ios::trunc);
+            if (!marker.is_open()) return false;
+
+            marker << MAGIC << "\n" << "bytes\t" << size << "\n";
+            if (!marker.good()) return false;
+        }
+
+        std::filesystem::rename(temp_path, marker_path, ec);
+        return !ec;
+    }
+
+    // recorded: bytes at close (0 if Missing), current: bytes now
+    static State check(const std::string& file_path, std::uint64_t& recorded, std::uint64_t& current) {
+        recorded = 0;
+        current = 0;
+
+        std::error_code ec;
+        current = std::filesystem::file_size(file_path, ec);
+        if (ec) current = 0;
+
+        std::ifstream marker(pathFor(file_path));
+        std::string line;
+        if (!std::getline(marker, line) || line != MAGIC) return State::Missing;
+        if (!std::getline(marker, line) || line.rfind("bytes\t", 0) != 0) return State::Missing;
+
+        try {
+            recorded = std::stoull(line.substr(6));
+        } catch (...) {
+            return State::Missing;
+        }
+
+        return (!ec && recorded == current) ? State::Complete : State::Mismatch;
+    }
+};
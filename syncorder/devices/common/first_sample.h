@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+
+/**
+ * @class FirstSample
+ * One-shot "first sample arrived" signal between a device callback and the
+ * thread waiting in warmup.
+ *
+ * arm() starts the clock, the callback calls signal() on every sample (a
+ * single relaxed load once signalled) and wait() sleeps on a condition
+ * variable instead of spinning.
+ */
+
+class FirstSample {
+private:
+    std::atomic<bool> received_{false};
+    std::chrono::steady_clock::time_point armed_at_{};
+    std::chrono::steady_clock::time_point received_at_{};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+public:
+    void arm() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        received_.store(false, std::memory_order_relaxed);
+        armed_at_ = std::chrono::steady_clock::now();
+        received_at_ = armed_at_;
+    }
+
+    // callback thread: only the first call after arm() takes the lock
+    void signal() {
+        if (received_.load(std::memory_order_relaxed)) return;
+
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (received_.load(std::memory_order_relaxed)) return;
+            received_at_ = now;
+            received_.store(true, std::memory_order_release);
+        }
+        cv_.notify_all();
+    }
+
+    // false on timeout
+    bool wait(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [this]() { return received_.load(std::memory_order_acquire); });
+    }
+
+    bool received() const {
+        return received_.load(std::memory_order_acquire);
+    }
+
+    // time from arm() to the first sample, in ms (0 until received)
+    double elapsedMs() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!received_.load(std::memory_order_relaxed)) return 0.0;
+        return std::chrono::duration<double, std::milli>(received_at_ - armed_at_).count();
+    }
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+
+/**
+ * @class FramePool
+ * Preallocated slab of fixed-size slots for frame payload copies.
+ *
+ * acquire() hands out a Lease over one free slot, or an empty Lease when
+ * every slot is leased (counted in exhausted()). A Lease returns its slot
+ * when destroyed, from whichever thread drops it. Slots are scanned from a
+ * rotating cursor, so with FIFO release acquire() finds one in O(1).
+ */
+
+class FramePool {
+public:
+    class Lease {
+    private:
+        FramePool* pool_ = nullptr;
+        std::size_t index_ = 0;
+
+    public:
+        Lease() = default;
+        Lease(FramePool* pool, std::size_t index) : pool_(pool), index_(index) {}
+        ~Lease() { reset(); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        Lease(Lease&& other) noexcept : pool_(std::exchange(other.pool_, nullptr)), index_(other.index_) {}
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                reset();
+                pool_ = std::exchange(other.pool_, nullptr);
+                index_ = other.index_;
+            }
+            return *this;
+        }
+
+        void reset() {
+            if (pool_) pool_->_release(index_);
+            pool_ = nullptr;
+        }
+
+        explicit operator bool() const { return pool_ != nullptr; }
+        std::uint8_t* data() const { return pool_ ? pool_->_slot(index_) : nullptr; }
+        std::size_t size() const { return pool_ ? pool_->slotSize() : 0; }
+    };
+
+private:
+    std::unique_ptr<std::uint8_t[]> slab_;
+    std::unique_ptr<std::atomic<bool>[]> leased_;
+    std::size_t slot_size_ = 0;
+    std::size_t slot_count_ = 0;
+    std::size_t cursor_ = 0;  // producer only
+
+    std::atomic<std::size_t> in_use_{0};
+    std::atomic<std::size_t> peak_in_use_{0};
+    std::atomic<std::uint64_t> exhausted_{0};
+
+public:
+    FramePool(std::size_t slot_count, std::size_t slot_size)
+    :
+        slab_(new std::uint8_t[slot_count * _aligned(slot_size)]),
+        leased_(new std::atomic<bool>[slot_count]),
+        slot_size_(_aligned(slot_size)),
+        slot_count_(slot_count)
+    {
+        for (std::size_t i = 0; i < slot_count_; ++i) leased_[i].store(false, std::memory_order_relaxed);
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+public:
+    // single producer
+    Lease acquire() {
+        for (std::size_t n = 0; n < slot_count_; ++n) {
+            std::size_t index = cursor_;
+            cursor_ = (cursor_ + 1 == slot_count_) ? 0 : cursor_ + 1;
+
+            if (!leased_[index].load(std::memory_order_relaxed)
+                && !leased_[index].exchange(true, std::memory_order_acquire)) {
+                std::size_t used = in_use_.fetch_add(1, std::memory_order_relaxed) + 1;
+                if (used > peak_in_use_.load(std::memory_order_relaxed)) peak_in_use_.store(used, std::memory_order_relaxed);
+                return Lease(this, index);
+            }
+        }
+
+        exhausted_.fetch_add(1, std::memory_order_relaxed);
+        return Lease();
+    }
+
+    std::size_t slotSize() const { return slot_size_; }
+    std::size_t slotCount() const { return slot_count_; }
+    std::size_t inUse() const { return in_use_.load(std::memory_order_relaxed); }
+    std::size_t peakInUse() const { return peak_in_use_.load(std::memory_order_relaxed); }
+    std::uint64_t exhausted() const { return exhausted_.load(std::memory_order_relaxed); }
+
+private:
+    static std::size_t _aligned(std::size_t size) { return (size + 63) & ~std::size_t(63); }
+
+    std::uint8_t* _slot(std::size_t index) const { return slab_.get() + index * slot_size_; }
+
+    void _release(std::size_t index) {
+        in_use_.fetch_sub(1, std::memory_order_relaxed);
+        leased_[index].store(false, std::memory_order_release);
+    }
+};
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <ostream>
 #include <string>
 
+// local
+#include <syncorder/core/task_pool.h>
+
 
 /**
  * @class
@@ -17,8 +21,8 @@ public:
     virtual bool start() = 0;
     virtual bool stop() = 0;
     virtual bool cleanup() = 0;
-    virtual bool check() = 0;
-    virtual bool verify() = 0;
+    virtual bool check(std::ostream& log) = 0;
+    virtual bool verify(TaskPool& pool, std::ostream& log) = 0;
 
     virtual std::string __name__() const = 0;
 
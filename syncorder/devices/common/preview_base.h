@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+/**
+ * @class TripleBuffer
+ * Lock-free latest-value slot for one writer and one reader.
+ *
+ * The writer fills back() and publish()es it; the reader acquire()s the most
+ * recently published slot and reads front(). Neither side ever waits, and
+ * intermediate values the reader did not pick up are simply overwritten.
+ */
+
+template<typename T>
+class TripleBuffer {
+private:
+    static constexpr std::uint8_t INDEX_MASK = 0x3;
+    static constexpr std::uint8_t FRESH = 0x4;  // middle slot holds an unread value
+
+    std::array<T, 3> slots_{};
+
+    // writer line
+    alignas(64) std::uint8_t back_ = 0;
+    // shared line
+    alignas(64) std::atomic<std::uint8_t> middle_{1};
+    // reader line
+    alignas(64) std::uint8_t front_ = 2;
+
+public:
+    // writer side
+    T& back() { return slots_[back_]; }
+
+    void publish() {
+        std::uint8_t previous = middle_.exchange(static_cast<std::uint8_t>(back_ | FRESH), std::memory_order_acq_rel);
+        back_ = previous & INDEX_MASK;
+    }
+
+    // reader side: true if front() changed since the last call
+    bool acquire() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) return false;
+
+        std::uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const { return slots_[front_]; }
+};
+
+
+/**
+ * @struct PreviewImage
+ * Owned, downscaled copy of a video frame.
+ */
+
+struct PreviewImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::uint64_t frame_number = 0;
+    double timestamp = 0.0;  // ms, device clock of the source frame
+    std::vector<std::uint8_t> pixels;  // tightly packed rows
+
+    bool empty() const { return width == 0 || height == 0; }
+    std::size_t stride() const { return static_cast<std::size_t>(width) * channels; }
+};
+
+using PreviewSlot = TripleBuffer<PreviewImage>;
+
+
+/**
+ * @brief nearest-neighbour downscaling
+ * Every step-th pixel is kept so that the result is at most max_width wide.
+ */
+
+inline int previewStep(int width, int max_width) {
+    return (max_width > 0 && width > max_width) ? (width + max_width - 1) / max_width : 1;
+}
+
+inline int previewExtent(int extent, int step) {
+    return (extent + step - 1) / step;
+}
+
+// packed pixels of any channel count into tightly packed rows at dst
+inline void downscalePixels(std::uint8_t* dst,
+                            const std::uint8_t* src, int width, int height, int channels, int src_stride,
+                            int step) {
+    std::size_t row_bytes = static_cast<std::size_t>(previewExtent(width, step)) * channels;
+
+    for (int y = 0; y < height; y += step) {
+        const std::uint8_t* row = src + static_cast<std::size_t>(y) * src_stride;
+
+        if (step == 1) {
+            std::memcpy(dst, row, row_bytes);
+            dst += row_bytes;
+            continue;
+        }
+
+        for (int x = 0; x < width; x += step) {
+            std::memcpy(dst, row + static_cast<std::size_t>(x) * channels, channels);
+            dst += channels;
+        }
+    }
+}
+
+// z16 depth into rgb8 false color: near red, far blue, no data black
+inline void colorizeDepth(std::uint8_t* dst,
+                          const std::uint16_t* src, int width, int height, int src_stride,
+                          int step, float depth_units, float max_meters) {
+    float scale = (max_meters > 0.0f) ? depth_units / max_meters : 0.0f;
+
+    for (int y = 0; y < height; y += step) {
+        const auto* row = reinterpret_cast<const std::uint16_t*>(reinterpret_cast<const std::uint8_t*>(src) + static_cast<std::size_t>(y) * src_stride);
+
+        for (int x = 0; x < width; x += step) {
+            std::uint16_t raw = row[x];
+            if (raw == 0) {
+                dst[0] = dst[1] = dst[2] = 0;
+            } else {
+                float t = (std::min)(raw * scale, 1.0f);
+                // piecewise linear red -> yellow -> green -> cyan -> blue
+                float r = (std::max)(0.0f, (std::min)(1.0f, 2.0f - 4.0f * t));
+                float g = (std::max)(0.0f, (std::min)(1.0f, t < 0.5f ? 4.0f * t : 4.0f - 4.0f * t));
+                float b = (std::max)(0.0f, (std::min)(1.0f, 4.0f * t - 2.0f));
+                dst[0] = static_cast<std::uint8_t>(r * 255.0f);
+                dst[1] = static_cast<std::uint8_t>(g * 255.0f);
+                dst[2] = static_cast<std::uint8_t>(b * 255.0f);
+            }
+            dst += 3;
+        }
+    }
+}
+
+// preview.pixels only reallocates when the preview size changes
+inline void downscalePreview(PreviewImage& preview,
+                             const std::uint8_t* src, int width, int height, int channels, int src_stride,
+                             int max_width) {
+    int step = previewStep(width, max_width);
+
+    preview.width = previewExtent(width, step);
+    preview.height = previewExtent(height, step);
+    preview.channels = channels;
+    preview.pixels.resize(preview.stride() * preview.height);
+
+    downscalePixels(preview.pixels.data(), src, width, height, channels, src_stride, step);
+}
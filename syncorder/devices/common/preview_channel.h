@@ -0,0 +1,228 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+// local
+#include <syncorder/io/shared_memory.h>
+#include <syncorder/devices/common/preview_base.h>
+
+
+/**
+ * Shared-memory preview channel
+ *
+ *   [SharedPreviewHeader][stream 0: slot x slot_count][stream 1: ...]
+ *   slot = [SharedPreviewFrame][payload_capacity bytes]
+ *
+ * Each stream is a small ring of seqlocked slots. The writer fills the slot
+ * after the latest one (sequence odd while writing, even when done) and then
+ * advances `published`; readers copy the latest slot and retry if its
+ * sequence moved underneath them. The writer never waits on readers.
+ */
+
+enum class PreviewStream : std::uint32_t { Color = 0, Depth = 1 };
+
+constexpr std::uint32_t PREVIEW_STREAM_COUNT = 2;
+constexpr char PREVIEW_CHANNEL_MAGIC[8] = {'S', 'Y', 'N', 'P', 'R', 'E', 'V', '\0'};
+constexpr std::uint32_t PREVIEW_CHANNEL_VERSION = 1;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared atomics must be lock-free");
+
+struct alignas(64) SharedPreviewHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t stream_count;
+    std::uint32_t slot_count;
+    std::uint32_t slot_size;          // frame header + payload, multiple of 64
+    std::uint32_t payload_capacity;
+    std::uint32_t reserved;
+    std::atomic<std::uint64_t> published[PREVIEW_STREAM_COUNT];  // frames published per stream
+};
+
+struct alignas(64) SharedPreviewFrame {
+    std::atomic<std::uint64_t> sequence;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t channels;
+    std::uint32_t bytes;
+    std::uint64_t frame_number;
+    double timestamp;                 // ms, device clock of the source frame
+};
+
+
+/**
+ * @class SharedPreviewWriter
+ */
+
+class SharedPreviewWriter {
+private:
+    SharedMemory memory_;
+    SharedPreviewHeader* header_ = nullptr;
+    SharedPreviewFrame* writing_ = nullptr;
+    PreviewStream writing_stream_ = PreviewStream::Color;
+
+public:
+    bool create(const std::string& name, std::uint32_t payload_capacity, std::uint32_t slot_count = 3) {
+        std::uint32_t slot_size = static_cast<std::uint32_t>((sizeof(SharedPreviewFrame) + payload_capacity + 63) & ~std::size_t(63));
+        std::size_t size = sizeof(SharedPreviewHeader) + std::size_t(PREVIEW_STREAM_COUNT) * slot_count * slot_size;
+
+        if (!memory_.create(name, size)) return false;
+        std::memset(memory_.data(), 0, size);
+
+        header_ = new (memory_.data()) SharedPreviewHeader();
+        header_->version = PREVIEW_CHANNEL_VERSION;
+        header_->stream_count = PREVIEW_STREAM_COUNT;
+        header_->slot_count = slot_count;
+        header_->slot_size = slot_size;
+        header_->payload_capacity = payload_capacity;
+        for (auto& published : header_->published) published.store(0, std::memory_order_relaxed);
+
+        for (std::uint32_t s = 0; s < PREVIEW_STREAM_COUNT; ++s) {
+            for (std::uint32_t i = 0; i < slot_count; ++i) {
+                new (_slotAt(s, i)) SharedPreviewFrame();
+            }
+        }
+
+        // magic last: readers only trust a fully initialised header
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header_->magic, PREVIEW_CHANNEL_MAGIC, sizeof(header_->magic));
+        return true;
+    }
+
+    void close() {
+        memory_.close();
+        header_ = nullptr;
+        writing_ = nullptr;
+    }
+
+    bool isOpen() const { return header_ != nullptr; }
+    std::uint32_t payloadCapacity() const { return header_ ? header_->payload_capacity : 0; }
+
+    // returns the payload to fill, or nullptr if the image does not fit
+    std::uint8_t* begin(PreviewStream stream, int width, int height, int channels) {
+        if (!header_) return nullptr;
+
+        std::size_t bytes = static_cast<std::size_t>(width) * height * channels;
+        if (bytes > header_->payload_capacity) return nullptr;
+
+        auto s = static_cast<std::uint32_t>(stream);
+        std::uint64_t next = header_->published[s].load(std::memory_order_relaxed);
+        SharedPreviewFrame* frame = _slotAt(s, static_cast<std::uint32_t>(next % header_->slot_count));
+
+        std::uint64_t sequence = frame->sequence.load(std::memory_order_relaxed);
+        frame->sequence.store(sequence + 1, std::memory_order_relaxed);  // odd: being written
+        std::atomic_thread_fence(std::memory_order_release);
+
+        frame->width = static_cast<std::uint32_t>(width);
+        frame->height = static_cast<std::uint32_t>(height);
+        frame->channels = static_cast<std::uint32_t>(channels);
+        frame->bytes = static_cast<std::uint32_t>(bytes);
+
+        writing_ = frame;
+        writing_stream_ = stream;
+        return reinterpret_cast<std::uint8_t*>(frame + 1);
+    }
+
+    void commit(std::uint64_t frame_number, double timestamp) {
+        if (!writing_) return;
+
+        writing_->frame_number = frame_number;
+        writing_->timestamp = timestamp;
+
+        auto s = static_cast<std::uint32_t>(writing_stream_);
+        writing_->sequence.store(writing_->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        header_->published[s].fetch_add(1, std::memory_order_release);
+        writing_ = nullptr;
+    }
+
+private:
+    SharedPreviewFrame* _slotAt(std::uint32_t stream, std::uint32_t index) {
+        char* base = memory_.data() + sizeof(SharedPreviewHeader);
+        std::size_t offset = (std::size_t(stream) * header_->slot_count + index) * header_->slot_size;
+        return reinterpret_cast<SharedPreviewFrame*>(base + offset);
+    }
+};
+
+
+/**
+ * @class SharedPreviewReader
+ */
+
+class SharedPreviewReader {
+private:
+    SharedMemory memory_;
+    const SharedPreviewHeader* header_ = nullptr;
+    std::uint64_t seen_[PREVIEW_STREAM_COUNT] = {};
+
+public:
+    bool open(const std::string& name) {
+        header_ = nullptr;
+        if (!memory_.openRead(name)) return false;
+        if (memory_.size() < sizeof(SharedPreviewHeader)) { memory_.close(); return false; }
+
+        const auto* header = reinterpret_cast<const SharedPreviewHeader*>(memory_.data());
+        if (std::memcmp(header->magic, PREVIEW_CHANNEL_MAGIC, sizeof(header->magic)) != 0
+            || header->version != PREVIEW_CHANNEL_VERSION
+            || header->stream_count != PREVIEW_STREAM_COUNT) {
+            memory_.close();
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        header_ = header;
+        for (auto& seen : seen_) seen = 0;
+        return true;
+    }
+
+    void close() {
+        memory_.close();
+        header_ = nullptr;
+    }
+
+    bool isOpen() const { return header_ != nullptr; }
+
+    // copies the newest frame of stream into out; false if nothing new or it was overwritten mid-copy
+    bool read(PreviewStream stream, PreviewImage& out) {
+        if (!header_) return false;
+
+        auto s = static_cast<std::uint32_t>(stream);
+        std::uint64_t published = header_->published[s].load(std::memory_order_acquire);
+        if (published == 0 || published == seen_[s]) return false;
+
+        const SharedPreviewFrame* frame = _slotAt(s, static_cast<std::uint32_t>((published - 1) % header_->slot_count));
+
+        std::uint64_t before = frame->sequence.load(std::memory_order_acquire);
+        if (before & 1) return false;
+
+        std::uint32_t bytes = frame->bytes;
+        if (bytes > header_->payload_capacity) return false;
+
+        out.width = static_cast<int>(frame->width);
+        out.height = static_cast<int>(frame->height);
+        out.channels = static_cast<int>(frame->channels);
+        out.frame_number = frame->frame_number;
+        out.timestamp = frame->timestamp;
+        out.pixels.resize(bytes);
+        std::memcpy(out.pixels.data(), frame + 1, bytes);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (frame->sequence.load(std::memory_order_relaxed) != before) return false;
+
+        seen_[s] = published;
+        return true;
+    }
+
+    std::uint64_t published(PreviewStream stream) const {
+        return header_ ? header_->published[static_cast<std::uint32_t>(stream)].load(std::memory_order_acquire) : 0;
+    }
+
+private:
+    const SharedPreviewFrame* _slotAt(std::uint32_t stream, std::uint32_t index) const {
+        const char* base = memory_.data() + sizeof(SharedPreviewHeader);
+        std::size_t offset = (std::size_t(stream) * header_->slot_count + index) * header_->slot_size;
+        return reinterpret_cast<const SharedPreviewFrame*>(base + offset);
+    }
+};
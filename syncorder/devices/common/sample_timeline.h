@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * @struct SampleTimeline
+ * Sample times (seconds) of one data file, sorted once, with a running count
+ * of flagged samples. Any [start, end] window is then two binary searches,
+ * so a file is read once however many videos it covers.
+ */
+struct SampleTimeline {
+    struct Window {
+        int total{0};
+        int flagged{0};
+    };
+
+    std::vector<double> times;
+    std::vector<std::uint8_t> flags;
+    std::vector<std::uint32_t> flagged_before;  // flagged samples in times[0, i)
+
+    void add(double time_sec, bool flag = false) {
+        if (std::isnan(time_sec)) return;  // never inside a window
+        times.push_back(time_sec);
+        flags.push_back(flag ? 1 : 0);
+    }
+
+    // call once after the last add()
+    void finish() {
+        // recordings are written in order; only sort what is not
+        if (!std::is_sorted(times.begin(), times.end())) {
+            std::vector<std::size_t> order(times.size());
+            for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::stable_sort(order.begin(), order.end(),
+                             [this](std::size_t a, std::size_t b) { return times[a] < times[b]; });
+
+            std::vector<double> sorted_times(times.size());
+            std::vector<std::uint8_t> sorted_flags(flags.size());
+            for (std::size_t i = 0; i < order.size(); ++i) {
+                sorted_times[i] = times[order[i]];
+                sorted_flags[i] = flags[order[i]];
+            }
+            times.swap(sorted_times);
+            flags.swap(sorted_flags);
+        }
+
+        flagged_before.assign(times.size() + 1, 0);
+        for (std::size_t i = 0; i < flags.size(); ++i) {
+            flagged_before[i + 1] = flagged_before[i] + flags[i];
+        }
+        flags.clear();
+        flags.shrink_to_fit();
+    }
+
+    std::size_t size() const { return times.size(); }
+
+    // samples with start <= time <= end
+    Window window(double start, double end) const {
+        Window result;
+        if (times.empty() || end < start) return result;
+
+        auto first = std::lower_bound(times.begin(), times.end(), start);
+        auto last = std::upper_bound(first, times.end(), end);
+        std::size_t begin_index = static_cast<std::size_t>(first - times.begin());
+        std::size_t end_index = static_cast<std::size_t>(last - times.begin());
+
+        result.total = static_cast<int>(end_index - begin_index);
+        result.flagged = static_cast<int>(flagged_before[end_index] - flagged_before[begin_index]);
+        return result;
+    }
+};
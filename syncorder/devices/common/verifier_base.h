@@ -1,12 +1,19 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <map>
 #include <vector>
+#include <exception>
+
+// local
+#include <syncorder/core/task_pool.h>
+#include <syncorder/devices/common/sample_timeline.h>
+#include <syncorder/devices/common/verify_cache.h>
 
 
 /**
@@ -50,20 +57,73 @@ protected:
     int valid_sessions_{0};
     int total_sessions_{0};
 
+    TaskPool* pool_{nullptr};
+    std::ostream* log_{&std::cout};
+    VerifyCache cache_;
+
 public:
     BVerifier() = default;
     virtual ~BVerifier() = default;
 
 public:
-    virtual bool verify() = 0;
+    // sessions and files are spread over pool; messages go to log (std::cout when run serially)
+    virtual bool verify(TaskPool& pool, std::ostream& log) = 0;
 
 protected:
+    std::ostream& _log() { return *log_; }
+
+    // task(i, log) for every i in [0, count) on the pool; each task logs to its own
+    // buffer and the buffers are printed in index order, so output matches a serial run
+    template<typename Task>
+    void _runEach(std::size_t count, Task&& task) {
+        std::vector<std::ostringstream> logs(count);
+        TaskPool::Group group;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            pool_->submit(group, [&task, &logs, i]() { task(i, logs[i]); });
+        }
+
+        std::exception_ptr error;
+        try {
+            pool_->wait(group);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        for (auto& log : logs) _log() << log.str();
+        if (error) std::rethrow_exception(error);
+    }
+
+    // fingerprints every file, reuses cached results of the unchanged ones and runs
+    // read(file, log) on the rest in parallel; read fills entry and sets ready
+    template<typename Read>
+    void _reuseOrRead(std::vector<CachedFile>& files, Read&& read) {
+        _runEach(files.size(), [&files](std::size_t i, std::ostream&) {
+            files[i].fingerprinted = FileFingerprint::of(files[i].path, files[i].fingerprint);
+        });
+
+        std::vector<std::size_t> stale;
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            if (cache_.reuse(files[i])) {
+                _log() << "[Verifier] Unchanged, using cached results: " << files[i].path << "\n";
+            } else {
+                stale.push_back(i);
+            }
+        }
+
+        _runEach(stale.size(), [&](std::size_t n, std::ostream& task_log) {
+            read(files[stale[n]], task_log);
+        });
+
+        for (std::size_t i : stale) cache_.keep(files[i]);
+    }
+
     // Parse frame_timing.log file
-    FrameTimingData _parseFrameTiming(const std::string& timing_path) {
+    FrameTimingData _parseFrameTiming(const std::string& timing_path, std::ostream& log) {
         FrameTimingData data;
 
         if (!std::filesystem::exists(timing_path)) {
-            std::cout << "[Verifier] frame_timing.log not found: " << timing_path << "\n";
+            log << "[Verifier] frame_timing.log not found: " << timing_path << "\n";
             return data;
         }
 
@@ -118,15 +178,15 @@ protected:
             data.valid = !data.videos.empty();
 
             if (data.valid) {
-                std::cout << "[Verifier] Parsed " << data.videos.size() << " video(s) from frame_timing\n";
+                log << "[Verifier] Parsed " << data.videos.size() << " video(s) from frame_timing\n";
                 for (const auto& video : data.videos) {
-                    std::cout << "[Verifier]   " << video.getVideoName()
-                              << " (duration: " << video.getDuration() << "s)\n";
+                    log << "[Verifier]   " << video.getVideoName()
+                        << " (duration: " << video.getDuration() << "s)\n";
                 }
             }
 
         } catch (const std::exception& e) {
-            std::cout << "[Verifier] Error parsing frame_timing.log: " << e.what() << "\n";
+            log << "[Verifier] Error parsing frame_timing.log: " << e.what() << "\n";
             data.valid = false;
         }
 
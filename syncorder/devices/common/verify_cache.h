@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// local
+#include <syncorder/devices/common/sample_timeline.h>
+
+
+/**
+ * @struct FileFingerprint
+ * Cheap identity of a file: size, mtime and a hash of its first, middle and
+ * last 16KB (the size goes into the hash too). Reading 48KB at most keeps
+ * fingerprinting a multi-GB recording in the sub-millisecond range, while
+ * still catching rewrites that keep size and mtime.
+ */
+
+struct FileFingerprint {
+    std::uint64_t size{0};
+    std::int64_t mtime{0};
+    std::uint64_t hash{0};
+
+    bool operator==(const FileFingerprint& other) const {
+        return size == other.size && mtime == other.mtime && hash == other.hash;
+    }
+    bool operator!=(const FileFingerprint& other) const { return !(*this == other); }
+
+    static constexpr std::size_t SAMPLE_BYTES = 16 * 1024;
+
+    static bool of(const std::string& path, FileFingerprint& out) {
+        std::error_code ec;
+        std::uint64_t size = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto mtime = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        // fnv-1a 64
+        std::uint64_t hash = 14695981039346656037ULL;
+        auto mix = [&hash](const unsigned char* data, std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                hash ^= data[i];
+                hash *= 1099511628211ULL;
+            }
+        };
+        mix(reinterpret_cast<const unsigned char*>(&size), sizeof(size));
+
+        std::vector<char> block(SAMPLE_BYTES);
+        std::uint64_t offsets[3] = {0, size / 2, size > SAMPLE_BYTES ? size - SAMPLE_BYTES : 0};
+        for (std::uint64_t offset : offsets) {
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(offset));
+            file.read(block.data(), static_cast<std::streamsize>(block.size()));
+            mix(reinterpret_cast<const unsigned char*>(block.data()), static_cast<std::size_t>(file.gcount()));
+        }
+
+        out.size = size;
+        out.mtime = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+        out.hash = hash;
+        return true;
+    }
+};
+
+
+struct CachedFile;
+
+
+/**
+ * @class VerifyCache
+ * Per-file verification results from earlier runs, kept in
+ * <verified_path>/<device>_verify_cache.log.
+ *
+ * An entry holds the fingerprint of the file it was computed from, one
+ * per-file value (bag validity, gaze log rate, ...) and the sample counts
+ * of every video window looked up in it. lookup() only returns entries
+ * whose fingerprint still matches, so a new or rewritten file is always
+ * re-read. Single-threaded: look up before fanning out, store after.
+ */
+
+class VerifyCache {
+public:
+    struct Entry {
+        FileFingerprint fingerprint;
+        std::int64_t value{0};
+        std::map<std::pair<double, double>, SampleTimeline::Window> windows;  // [start, end] -> counts
+
+        // counts of one window, false if it was never looked up in this file
+        bool findWindow(double start, double end, SampleTimeline::Window& out) const {
+            auto it = windows.find({start, end});
+            if (it == windows.end()) return false;
+            out = it->second;
+            return true;
+        }
+    };
+
+private:
+    static constexpr const char* MAGIC = "syncorder_verify_cache 1";
+
+    std::string path_;
+    std::map<std::string, Entry> entries_;  // previous run, read only
+    std::map<std::string, Entry> used_;     // this run, written back
+
+public:
+    // rebuild: ignore what is on disk (still written back at save())
+    void load(const std::string& path, bool rebuild) {
+        path_ = path;
+        entries_.clear();
+        used_.clear();
+        if (rebuild) return;
+
+        std::ifstream file(path);
+        std::string line;
+        if (!std::getline(file, line) || line != MAGIC) return;
+
+        Entry* current = nullptr;
+        while (std::getline(file, line)) {
+            std::vector<std::string> fields = _split(line);
+            if (fields.empty()) continue;
+
+            try {
+                if (fields[0] == "file" && fields.size() == 6) {
+                    Entry entry;
+                    entry.fingerprint.size = std::stoull(fields[2]);
+                    entry.fingerprint.mtime = std::stoll(fields[3]);
+                    entry.fingerprint.hash = std::stoull(fields[4], nullptr, 16);
+                    entry.value = std::stoll(fields[5]);
+                    current = &(entries_[fields[1]] = entry);
+                } else if (fields[0] == "window" && fields.size() == 5 && current) {
+                    SampleTimeline::Window window;
+                    window.total = std::stoi(fields[3]);
+                    window.flagged = std::stoi(fields[4]);
+                    current->windows[{std::stod(fields[1]), std::stod(fields[2])}] = window;
+                }
+            } catch (...) {
+                current = nullptr; // damaged line: drop that entry's remaining windows
+            }
+        }
+    }
+
+    // entry for path if its fingerprint still matches; kept for save()
+    const Entry* lookup(const std::string& path, const FileFingerprint& fingerprint) {
+        auto it = entries_.find(path);
+        if (it == entries_.end() || it->second.fingerprint != fingerprint) return nullptr;
+        return &(used_[path] = it->second);
+    }
+
+    void store(const std::string& path, Entry entry) {
+        used_[path] = std::move(entry);
+    }
+
+    // true when file is unchanged and its cached entry covers every window
+    bool reuse(CachedFile& file);
+
+    // remember file's result for the next run
+    void keep(const CachedFile& file);
+
+    // writes the entries used by this run; replaces the file in one rename
+    bool save() const {
+        if (path_.empty()) return false;
+
+        std::string temp_path = path_ + ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::trunc);
+            if (!file.is_open()) return false;
+
+            file << MAGIC << "\n";
+            char number[32];
+            for (const auto& [path, entry] : used_) {
+                std::snprintf(number, sizeof(number), "%016llx", static_cast<unsigned long long>(entry.fingerprint.hash));
+                file << "file\t" << path << "\t" << entry.fingerprint.size << "\t" << entry.fingerprint.mtime
+                     << "\t" << number << "\t" << entry.value << "\n";
+
+                for (const auto& [range, window] : entry.windows) {
+                    file << "window\t" << _exact(range.first) << "\t" << _exact(range.second)
+                         << "\t" << window.total << "\t" << window.flagged << "\n";
+                }
+            }
+            if (!file.good()) return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp_path, path_, ec);
+        return !ec;
+    }
+
+private:
+    // round-trips through stod
+    static std::string _exact(double value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.17g", value);
+        return text;
+    }
+
+    static std::vector<std::string> _split(const std::string& line) {
+        std::vector<std::string> fields;
+        std::istringstream iss(line);
+        std::string field;
+        while (std::getline(iss, field, '\t')) fields.push_back(field);
+        return fields;
+    }
+};
+
+
+/**
+ * @struct CachedFile
+ * One input file of a verify run and the windows it has to answer for.
+ * entry is either reused from the cache or filled in after reading the
+ * file; ready tells whether it holds a result.
+ */
+
+struct CachedFile {
+    std::string path;
+    std::vector<std::pair<double, double>> windows;
+
+    FileFingerprint fingerprint;
+    bool fingerprinted{false};
+
+    VerifyCache::Entry entry;
+    bool ready{false};
+};
+
+inline bool VerifyCache::reuse(CachedFile& file) {
+    if (!file.fingerprinted) return false;
+
+    const Entry* cached = lookup(file.path, file.fingerprint);
+    if (!cached) return false;
+
+    SampleTimeline::Window window;
+    for (const auto& range : file.windows) {
+        if (!cached->findWindow(range.first, range.second, window)) return false;
+    }
+
+    file.entry = *cached;
+    file.ready = true;
+    return true;
+}
+
+inline void VerifyCache::keep(const CachedFile& file) {
+    if (!file.fingerprinted || !file.ready) return;
+
+    Entry entry = file.entry;
+    entry.fingerprint = file.fingerprint;
+    store(file.path, std::move(entry));
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <thread>
 #include <chrono>
@@ -16,8 +17,15 @@
 // local
 #include <syncorder/gonfig/gonfig.h>
 #include <syncorder/error/exception.h>
+#include <syncorder/io/async_writer.h>
+#include <syncorder/gonfig/writer_options.h>
+#include <syncorder/io/csv_formatter.h>
 #include <syncorder/devices/common/broker_base.h>
+#include <syncorder/devices/common/preview_base.h>
+#include <syncorder/devices/common/preview_channel.h>
 #include <syncorder/devices/realsense/model.h>
+#include <syncorder/devices/realsense/device.cpp>
+#include <syncorder/monitoring/realsense_monitor.h>
 
 // third-party
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -30,15 +38,27 @@
 
 class RealsenseBroker : public TBBroker<RealsenseBufferData> {
 private:
-    std::ofstream csv_;
+    AsyncWriter csv_;
+    CsvFormatter batch_;
     std::string output_;
     size_t index_ = 0;
 
-    // image saver
+    // monitor feed, written only by the broker thread
+    RealsenseFrameCounters* counters_ = nullptr;
+
+    // live preview: shared memory channel, optional monitor.png fallback
+    static constexpr float PREVIEW_DEPTH_MAX_METERS = 4.0f;
+
+    SharedPreviewWriter shared_preview_;
+    bool preview_oversize_logged_ = false;
+    std::chrono::steady_clock::duration preview_interval_{};
+    std::chrono::steady_clock::time_point last_preview_{};
+
+    // image saver: owned downscaled copies, no SDK frame is kept alive
+    bool save_png_ = false;
     std::thread image_thread_;
     std::atomic<bool> image_running_{false};
-    rs2::frame current_frame_;
-    std::mutex frame_mutex_;
+    PreviewSlot preview_;
 
 public:
     RealsenseBroker(bool create_output) {
@@ -47,8 +67,12 @@ public:
         if (create_output) {
             std::filesystem::create_directories(output_);
             
-            csv_.open(output_ + "realsense_data.csv");
-            csv_ << "index,color_timestamp,depth_timestamp,color_frame_number,depth_frame_number\n";
+            if (!csv_.open(output_ + "realsense_data.csv", configuredWriterOptions())) {
+                throw RealsenseDeviceError("Failed to open " + output_ + "realsense_data.csv");
+            }
+            csv_.write(std::string("index,color_timestamp,depth_timestamp,color_frame_number,depth_frame_number\n"));
+
+            _setupPreview();
         }
     }
 
@@ -57,61 +81,157 @@ public:
 public:
     void start() {
         TBBroker<RealsenseBufferData>::start();
-        image_running_ = true;
-        image_thread_ = std::thread(&RealsenseBroker::_imageSaver, this);
+        if (save_png_) {
+            image_running_ = true;
+            image_thread_ = std::thread(&RealsenseBroker::_imageSaver, this);
+        }
     }
 
     void stop() {
         TBBroker<RealsenseBufferData>::stop();
         image_running_ = false;
         if (image_thread_.joinable()) image_thread_.join();
+        shared_preview_.close();
     }
 
     void cleanup() {
-        csv_.flush();
         csv_.close();
     }
 
+    const AsyncWriter& writer() const {
+        return csv_;
+    }
+
+    void setCounters(RealsenseFrameCounters* counters) {
+        counters_ = counters;
+    }
+
 protected:
     void _process(const RealsenseBufferData& data) override {
-        _write(data);
+        _processBatch(&data, 1);
+    }
 
-        // Update current frame for image saver
-        std::lock_guard<std::mutex> lock(frame_mutex_);
-        current_frame_ = data.color_frame;
+    void _processBatch(const RealsenseBufferData* data, std::size_t count) override {
+        for (std::size_t i = 0; i < count; ++i) _write(data[i]);
+
+        if (counters_) {
+            for (std::size_t i = 0; i < count; ++i) counters_->record(data[i].arrival, data[i].color.timestamp);
+        }
+
+        // one hand-off to the writer thread per batch
+        csv_.write(batch_.data(), batch_.size());
+        batch_.clear();
+
+        // preview (latest of the batch only)
+        _publishPreview(data[count - 1]);
     }
 
 private:
     void _write(const RealsenseBufferData& data) {
         // Use high precision output for timestamps
-        csv_ << index_ << ","
-             << std::fixed << std::setprecision(14) << data.color_frame.get_timestamp() << ","
-             << std::fixed << std::setprecision(14) << data.depth_frame.get_timestamp() << ","
-             << data.color_frame.get_frame_number() << ","
-             << data.depth_frame.get_frame_number() << "\n";
+        batch_
+            .integer(index_).sep()
+            .fixed(data.color.timestamp, 14).sep()
+            .fixed(data.depth.timestamp, 14).sep()
+            .integer(data.color.frame_number).sep()
+            .integer(data.depth.frame_number).end();
         index_++;
     }
 
+    void _setupPreview() {
+        if (gonfig.preview_rate_hz <= 0) return;
+        preview_interval_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / gonfig.preview_rate_hz));
+
+        if (!gonfig.preview_shm_name.empty()) {
+            // a full-resolution frame (preview_max_width 0), or any aspect ratio up to square at preview_max_width
+            std::uint32_t capacity = static_cast<std::uint32_t>(RealsenseDevice::STREAM_WIDTH) * RealsenseDevice::STREAM_HEIGHT * 3;
+            if (gonfig.preview_max_width > 0) {
+                capacity = (std::min)(capacity, static_cast<std::uint32_t>(gonfig.preview_max_width) * gonfig.preview_max_width * 3);
+            }
+
+            if (shared_preview_.create(gonfig.preview_shm_name, capacity)) {
+                std::cout << "[Realsense] Live preview on shared memory \"" << gonfig.preview_shm_name << "\"\n";
+            } else {
+                std::cout << "[Realsense] Warning: cannot create shared memory preview \"" << gonfig.preview_shm_name << "\"\n";
+            }
+        }
+
+        save_png_ = gonfig.preview_png;
+    }
+
+    void _publishPreview(const RealsenseBufferData& data) {
+        if (!shared_preview_.isOpen() && !save_png_) return;
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_preview_ < preview_interval_) return;
+        last_preview_ = now;
+
+        const RealsenseFrameInfo& color = data.color;
+        if (color) {
+            const auto* pixels = static_cast<const std::uint8_t*>(color.data);
+            int step = previewStep(color.width, gonfig.preview_max_width);
+            int width = previewExtent(color.width, step);
+            int height = previewExtent(color.height, step);
+
+            // downscaled straight into the shared slot
+            if (std::uint8_t* slot = _previewSlot(PreviewStream::Color, width, height, color.bytes_per_pixel)) {
+                downscalePixels(slot, pixels, color.width, color.height, color.bytes_per_pixel, color.stride, step);
+                shared_preview_.commit(color.frame_number, color.timestamp);
+            }
+
+            if (save_png_) {
+                PreviewImage& preview = preview_.back();
+                downscalePreview(preview, pixels,
+                                 color.width, color.height, color.bytes_per_pixel, color.stride,
+                                 gonfig.preview_max_width);
+                preview.frame_number = color.frame_number;
+                preview.timestamp = color.timestamp;
+                preview_.publish();
+            }
+        }
+
+        const RealsenseFrameInfo& depth = data.depth;
+        if (depth) {
+            int step = previewStep(depth.width, gonfig.preview_max_width);
+            int width = previewExtent(depth.width, step);
+            int height = previewExtent(depth.height, step);
+
+            if (std::uint8_t* slot = _previewSlot(PreviewStream::Depth, width, height, 3)) {
+                colorizeDepth(slot, static_cast<const std::uint16_t*>(depth.data),
+                              depth.width, depth.height, depth.stride,
+                              step, depth.depth_units, PREVIEW_DEPTH_MAX_METERS);
+                shared_preview_.commit(depth.frame_number, depth.timestamp);
+            }
+        }
+    }
+
+    // shared slot for one preview image; warns once when an image cannot fit
+    std::uint8_t* _previewSlot(PreviewStream stream, int width, int height, int channels) {
+        if (!shared_preview_.isOpen()) return nullptr;
+
+        std::uint8_t* slot = shared_preview_.begin(stream, width, height, channels);
+        if (!slot && !preview_oversize_logged_) {
+            std::cout << "[Realsense] Warning: " << width << "x" << height << "x" << channels
+                      << " preview exceeds the shared memory slot (" << shared_preview_.payloadCapacity()
+                      << " bytes), not published\n";
+            preview_oversize_logged_ = true;
+        }
+        return slot;
+    }
+
     void _imageSaver() {
         std::string filename = output_ + "monitor.png";
 
         while (image_running_) {
-            rs2::frame frame;
-            {
-                std::lock_guard<std::mutex> lock(frame_mutex_);
-                frame = current_frame_;
-            }
-
-            if (frame) {
-                auto vf = frame.as<rs2::video_frame>();
-                if (vf) {
-                    stbi_write_png(
-                        filename.c_str(),
-                        vf.get_width(), vf.get_height(),
-                        vf.get_bytes_per_pixel(), vf.get_data(),
-                        vf.get_width() * vf.get_bytes_per_pixel()
-                    );
-                }
+            if (preview_.acquire()) {
+                const PreviewImage& preview = preview_.front();
+                stbi_write_png(
+                    filename.c_str(),
+                    preview.width, preview.height,
+                    preview.channels, preview.pixels.data(),
+                    static_cast<int>(preview.stride())
+                );
             }
 
             std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -18,19 +18,7 @@
 
 /**
  * @class Buffer
+ * Sized at setup from the stream rate and gonfig.buffer_headroom_seconds.
  */
 
-constexpr std::size_t REALSENSE_RING_BUFFER_SIZE = 1024;
-
-class RealsenseBuffer : public BBuffer<RealsenseBufferData, REALSENSE_RING_BUFFER_SIZE> {
-    public:
-    static void* dequeue(void* instance) {
-        auto* buffer = static_cast<RealsenseBuffer*>(instance);
-        auto result = buffer->_dequeue();
-        if (!result.has_value()) return nullptr;
-        
-        return new RealsenseBufferData(std::move(result.value()));
-    }
-protected:
-    void onOverflow() noexcept override { std::cout << "[RealsenseBuffer Warning] Buffer overflow\n"; }
-};
\ No newline at end of file
+class RealsenseBuffer : public BBuffer<RealsenseBufferData, DYNAMIC_CAPACITY> {};
\ No newline at end of file
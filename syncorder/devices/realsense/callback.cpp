@@ -5,6 +5,8 @@
 
 // local
 #include <syncorder/devices/realsense/buffer.cpp> //TODO: include buffer
+#include <syncorder/devices/common/frame_pool.h>
+#include <syncorder/devices/common/first_sample.h>
 #include <syncorder/error/exception.h>
 #include <syncorder/monitoring/realsense_monitor.h>
 
@@ -18,41 +20,56 @@ private:
     static inline RealsenseCallback* instance_ = nullptr;
     void* buffer_;
     void* monitor_;
+    FramePool* pool_ = nullptr;
 
     // flag
-    std::atomic<bool> first_frame_received_;
+    FirstSample first_frame_;
+    static constexpr std::chrono::milliseconds WARMUP_TIMEOUT{10000};
 
 public:
     RealsenseCallback() {}
     ~RealsenseCallback() {}
 
 public:
-    void setup(void* buffer, void* monitor = nullptr) {
+    void setup(void* buffer, void* monitor = nullptr, FramePool* pool = nullptr) {
         instance_ = this;
         buffer_ = buffer;
         monitor_ = monitor;
+        pool_ = pool;
 
-        first_frame_received_.store(false);
+        first_frame_.arm();
     }
 
+    // restart the time-to-first-frame clock, right before the stream starts
+    void arm() {
+        first_frame_.arm();
+    }
+
+    // sleeps until the first frameset (no spinning)
     bool warmup() {
-        auto start = std::chrono::steady_clock::now();
-        auto end = std::chrono::milliseconds(10000);
-        
-        while (!first_frame_received_.load()) {
-            auto elapsed = std::chrono::steady_clock::now() - start;
-            if (elapsed >= end) {
-                if (monitor_) {
-                    auto* realsense_monitor = static_cast<RealsenseMonitor*>(monitor_);
-                    realsense_monitor->onError("Warmup timeout - no frames received within 10 seconds");
-                }
-                return false;
+        if (!first_frame_.wait(WARMUP_TIMEOUT)) {
+            if (monitor_) {
+                auto* realsense_monitor = static_cast<RealsenseMonitor*>(monitor_);
+                realsense_monitor->onError("Warmup timeout - no frames received within 10 seconds");
             }
+            return false;
+        }
+
+        double elapsed = first_frame_.elapsedMs();
+        std::cout << "[Realsense] First frame after " << static_cast<long long>(elapsed) << " ms\n";
+        if (monitor_) {
+            auto* realsense_monitor = static_cast<RealsenseMonitor*>(monitor_);
+            realsense_monitor->onDeviceEvent("FIRST_FRAME_RECEIVED", "First frame received after " + std::to_string(elapsed) + "ms");
         }
 
         return true;
     }
 
+    // ms from arm() to the first frameset, 0 if none arrived
+    double timeToFirstFrame() {
+        return first_frame_.elapsedMs();
+    }
+
     static void onFrameset(const rs2::frame& frame) {
         if (instance_) {
             instance_->_onFrameset(frame);
@@ -60,68 +77,39 @@ public:
     }
 
 private:
+    // stamp and enqueue only: the broker feeds the monitor downstream
     void _onFrameset(const rs2::frame& frame) {
-        try {
-            // flag
-            if (!first_frame_received_.load()) {
-                first_frame_received_.store(true);
-                if (monitor_) {
-                    auto* realsense_monitor = static_cast<RealsenseMonitor*>(monitor_);
-                    realsense_monitor->onDeviceEvent("FIRST_FRAME_RECEIVED", "First frame received successfully");
-                }
-            }
+        double arrival = std::chrono::duration<double, std::milli>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
 
-            // Monitor frame event
-            if (monitor_) {
-                try {
-                    auto current_time = std::chrono::duration<double, std::milli>(
-                        std::chrono::system_clock::now().time_since_epoch()).count();
-
-                    auto frame_timestamp = frame.get_timestamp();
-                    auto latency = current_time - frame_timestamp;
-
-                    auto* realsense_monitor = static_cast<RealsenseMonitor*>(monitor_);
-                    realsense_monitor->onFrameReceived(frame_timestamp, latency);
+        // flag
+        first_frame_.signal();
 
-                } catch (const std::exception& e) {
-                    if (monitor_) {
-                        auto* realsense_monitor = static_cast<RealsenseMonitor*>(monitor_);
-                        realsense_monitor->onError("Frame monitoring error: " + std::string(e.what()));
-                    }
-                }
-            }
+        if (!buffer_) return;
 
-            // buffer - enqueue frame data
-            if (buffer_) {
-                try {
-                    // Check if this is a frameset
-                    if (auto fs = frame.as<rs2::frameset>()) {
-                        auto color = fs.get_color_frame();
-                        auto depth = fs.get_depth_frame();
-
-                        if (color && depth) {
-                            auto* realsense_buffer = static_cast<RealsenseBuffer*>(buffer_);
-                            RealsenseBufferData data(color, depth);
-                            realsense_buffer->enqueue(std::move(data));
-                        }
-                    }
-                } catch (const std::exception& e) {
-                    if (monitor_) {
-                        auto* realsense_monitor = static_cast<RealsenseMonitor*>(monitor_);
-                        realsense_monitor->onError("Buffer enqueue error: " + std::string(e.what()));
+        try {
+            // Check if this is a frameset
+            if (auto fs = frame.as<rs2::frameset>()) {
+                auto color = fs.get_color_frame();
+                auto depth = fs.get_depth_frame();
+
+                if (color && depth) {
+                    auto* realsense_buffer = static_cast<RealsenseBuffer*>(buffer_);
+                    RealsenseBufferData data;
+
+                    // copy into the pool so the SDK gets its frames back now;
+                    // keep the SDK frames if the pool is exhausted
+                    if (!pool_ || !RealsenseBufferData::copyInto(data, pool_->acquire(), color, depth)) {
+                        data = RealsenseBufferData(color, depth);
                     }
+                    data.arrival = arrival;
+                    realsense_buffer->enqueue(std::move(data));
                 }
             }
-
         } catch (const std::exception& e) {
-            // Report to monitor if available
             if (monitor_) {
-                try {
-                    auto* realsense_monitor = static_cast<RealsenseMonitor*>(monitor_);
-                    realsense_monitor->onError("Critical frame error: " + std::string(e.what()));
-                } catch (...) {
-                    // Even monitor reporting failed - no fallback needed as monitor handles its own errors
-                }
+                auto* realsense_monitor = static_cast<RealsenseMonitor*>(monitor_);
+                realsense_monitor->onError("Buffer enqueue error: " + std::string(e.what()));
             }
         }
     }
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <thread>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -11,6 +10,8 @@
 // local
 #include <syncorder/gonfig/gonfig.h>
 #include <syncorder/devices/common/checker_base.h>
+#include <syncorder/devices/common/completion_marker.h>
+#include <syncorder/io/csv_scanner.h>
 
 
 /**
@@ -29,8 +30,9 @@ public:
     ~RealsenseChecker() = default;
 
 public:
-    bool check() override {
-        std::cout << "[Realsense] Starting check for flat structure\n";
+    bool check(std::ostream& log) override {
+        log_ = &log;
+        _log() << "[Realsense] Starting check for flat structure\n";
 
         result_ = true;
 
@@ -60,7 +62,7 @@ public:
                     result_ = false;
                 }
             } else {
-                std::cout << "[Realsense] Warning: No CSV file found\n";
+                _log() << "[Realsense] Warning: No CSV file found\n";
                 result_ = false;
             }
 
@@ -70,128 +72,117 @@ public:
                     result_ = false;
                 }
             } else {
-                std::cout << "[Realsense] Warning: No BAG file found\n";
+                _log() << "[Realsense] Warning: No BAG file found\n";
                 result_ = false;
             }
 
         } catch (const std::exception& e) {
-            std::cout << "[Realsense] Check error: " << e.what() << "\n";
+            _log() << "[Realsense] Check error: " << e.what() << "\n";
             result_ = false;
         }
 
         _writeResult();
 
-        std::cout << "[Realsense] Check phase " << (result_ ? "completed" : "failed") << "\n";
+        _log() << "[Realsense] Check phase " << (result_ ? "completed" : "failed") << "\n";
         return result_;
     }
 
 private:
     bool _checkCsv(const std::string& csv_path) {
-        std::cout << "[Realsense] Verifying CSV file: " << csv_path << "\n";
+        _log() << "[Realsense] Verifying CSV file: " << csv_path << "\n";
 
         if (!std::filesystem::exists(csv_path)) {
-            std::cout << "[Realsense] File does not exist\n";
+            _log() << "[Realsense] File does not exist\n";
             return false;
         }
 
         auto file_size = std::filesystem::file_size(csv_path);
-        std::cout << "[Realsense] File size: " << file_size << " bytes\n";
+        _log() << "[Realsense] File size: " << file_size << " bytes\n";
 
         if (file_size == 0) {
-            std::cout << "[Realsense] File is empty\n";
+            _log() << "[Realsense] File is empty\n";
             return false;
         }
 
         try {
-            std::ifstream file(csv_path);
-            std::string line;
-            int line_count = 0;
-            bool header_valid = false;
-
-            // Read and verify header
-            if (std::getline(file, line)) {
-                line_count++;
-                std::cout << "[Realsense] First line: " << line << "\n";
-                if (line.find("index,") == 0) {
-                    header_valid = true;
-                } else {
-                    std::cout << "[Realsense] Invalid CSV header format\n";
-                    return false;
-                }
-            } else {
-                std::cout << "[Realsense] Could not read first line\n";
+            CsvScanner scanner;
+            if (!scanner.open(csv_path)) {
+                _log() << "[Realsense] Could not open file\n";
                 return false;
             }
 
-            // Count data rows (excluding header)
-            while (std::getline(file, line)) {
-                if (!line.empty()) {
-                    line_count++;
-                }
+            // Read and verify header
+            std::string_view header = scanner.header();
+            _log() << "[Realsense] First line: " << header << "\n";
+            if (header.find("index,") != 0) {
+                _log() << "[Realsense] Invalid CSV header format\n";
+                return false;
             }
 
-            int data_row_count = line_count - 1; // Exclude header
-            int expected_frames = gonfig.record_duration * 60; // 60 fps
+            // Count data rows (excluding header); rows are only counted, never split
+            int data_row_count = static_cast<int>(scanner.countRows());
+            int expected_frames = gonfig.record_duration * gonfig.realsense_frame_rate;
 
-            std::cout << "[Realsense] Data rows: " << data_row_count << "\n";
-            std::cout << "[Realsense] Expected frames (60fps * " << gonfig.record_duration << "s): " << expected_frames << "\n";
+            _log() << "[Realsense] Data rows: " << data_row_count << "\n";
+            _log() << "[Realsense] Expected frames (" << gonfig.realsense_frame_rate << "fps * " << gonfig.record_duration << "s): " << expected_frames << "\n";
 
             if (data_row_count < expected_frames) {
-                std::cout << "[Realsense] Insufficient frames (expected: >=" << expected_frames << ", actual: " << data_row_count << ")\n";
+                _log() << "[Realsense] Insufficient frames (expected: >=" << expected_frames << ", actual: " << data_row_count << ")\n";
                 return false;
             }
 
             if (data_row_count > expected_frames) {
-                std::cout << "[Realsense] Extra frames recorded: +" << (data_row_count - expected_frames) << " frames (acceptable due to stop timing)\n";
+                _log() << "[Realsense] Extra frames recorded: +" << (data_row_count - expected_frames) << " frames (acceptable due to stop timing)\n";
             }
 
-            std::cout << "[Realsense] File verification successful\n";
+            _log() << "[Realsense] File verification successful\n";
             return true;
 
         } catch (const std::exception& e) {
-            std::cout << "[Realsense] File verification failed: " << e.what() << "\n";
+            _log() << "[Realsense] File verification failed: " << e.what() << "\n";
             return false;
         }
     }
 
     bool _checkBag(const std::string& bag_path) {
-        std::cout << "[Realsense] Verifying BAG file: " << bag_path << "\n";
+        _log() << "[Realsense] Verifying BAG file: " << bag_path << "\n";
 
         if (!std::filesystem::exists(bag_path)) {
-            std::cout << "[Realsense] File does not exist\n";
+            _log() << "[Realsense] File does not exist\n";
             return false;
         }
 
         auto file_size = std::filesystem::file_size(bag_path);
-        std::cout << "[Realsense] File size: " << file_size << " bytes\n";
+        _log() << "[Realsense] File size: " << file_size << " bytes\n";
 
         if (file_size == 0) {
-            std::cout << "[Realsense] File is empty\n";
+            _log() << "[Realsense] File is empty\n";
             return false;
         }
 
-        // Wait for file to stabilize (check if still being written)
-        std::cout << "[Realsense] Checking file stability...\n";
-        auto last_size = file_size;
-        for (int i = 0; i < 10; ++i) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            auto current_size = std::filesystem::file_size(bag_path);
-            if (current_size != last_size) {
-                std::cout << "[Realsense] File size changing, waiting...\n";
-                last_size = current_size;
-            } else {
-                break;
-            }
-            if (i == 9) {
-                std::cout << "[Realsense] File still changing after 1 second\n";
-                return false;
+        // completion marker: written by the recorder once the bag was closed cleanly
+        std::uint64_t recorded = 0;
+        std::uint64_t current = 0;
+        switch (CompletionMarker::check(bag_path, recorded, current)) {
+        case CompletionMarker::State::Complete:
+            _log() << "[Realsense] Completion marker matches (" << current << " bytes)\n";
+            if (!gonfig.verify_deep) {
+                _log() << "[Realsense] BAG file verification successful\n";
+                return true;
             }
+            break;
+        case CompletionMarker::State::Missing:
+            _log() << "[Realsense] No completion marker, opening with SDK\n";
+            break;
+        case CompletionMarker::State::Mismatch:
+            _log() << "[Realsense] Completion marker records " << recorded << " bytes, file has " << current << ", opening with SDK\n";
+            break;
         }
 
         // Verify BAG file by attempting to open with RealSense SDK
         try {
             std::string temp_path = bag_path + ".verify.bag";
-            std::cout << "[Realsense] Creating temporary copy for verification: " << temp_path << "\n";
+            _log() << "[Realsense] Creating temporary copy for verification: " << temp_path << "\n";
 
             std::filesystem::copy_file(bag_path, temp_path, std::filesystem::copy_options::overwrite_existing);
 
@@ -203,17 +194,17 @@ private:
             pipe.stop();
 
             std::filesystem::remove(temp_path);
-            std::cout << "[Realsense] BAG file verification successful\n";
+            _log() << "[Realsense] BAG file verification successful\n";
             return true;
 
         } catch (const rs2::error& e) {
-            std::cout << "[Realsense] RealSense error during BAG verification: " << e.what() << "\n";
+            _log() << "[Realsense] RealSense error during BAG verification: " << e.what() << "\n";
             return false;
         } catch (const std::filesystem::filesystem_error& e) {
-            std::cout << "[Realsense] Filesystem error during BAG verification: " << e.what() << "\n";
+            _log() << "[Realsense] Filesystem error during BAG verification: " << e.what() << "\n";
             return false;
         } catch (const std::exception& e) {
-            std::cout << "[Realsense] BAG verification failed: " << e.what() << "\n";
+            _log() << "[Realsense] BAG verification failed: " << e.what() << "\n";
             return false;
         }
     }
@@ -227,7 +218,7 @@ private:
         std::ofstream csv(csv_path);
 
         if (!csv.is_open()) {
-            std::cout << "[Realsense] Failed to create result CSV file: " << csv_path << "\n";
+            _log() << "[Realsense] Failed to create result CSV file: " << csv_path << "\n";
             return;
         }
 
@@ -235,6 +226,6 @@ private:
         csv << result_;
 
         csv.close();
-        std::cout << "[Realsense] Results written to " << csv_path << "\n";
+        _log() << "[Realsense] Results written to " << csv_path << "\n";
     }
 };
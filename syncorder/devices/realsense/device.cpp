@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <algorithm>
+#include <iostream>
 #include <thread>
 #include <filesystem>
 
@@ -11,6 +12,7 @@
 #include <syncorder/gonfig/gonfig.h>
 #include <syncorder/error/exception.h>
 #include <syncorder/devices/common/device_base.h>
+#include <syncorder/devices/common/completion_marker.h>
 
 
 /**
@@ -18,6 +20,10 @@
  */
 
 class RealsenseDevice : public BDevice {
+public:
+    static constexpr int STREAM_WIDTH = 640;
+    static constexpr int STREAM_HEIGHT = 480;
+
 private:
     rs2::pipeline pipe_;
     rs2::config config_;
@@ -68,20 +74,30 @@ public:
     
     bool _stop() override {
         try {
-            auto device = pipe_.get_active_profile().get_device();
+            {
+                auto device = pipe_.get_active_profile().get_device();
+
+                // Stop recording if active
+                if (auto recorder = device.as<rs2::recorder>()) {
+                    recorder.pause();
+                }
 
-            // Stop recording if active
-            if (auto recorder = device.as<rs2::recorder>()) {
-                recorder.pause();
+                // Stop the pipeline
+                pipe_.stop();
             }
 
-            // Stop the pipeline
-            pipe_.stop();
+            // the pipeline and config keep the record device (and the bag) open until they are released
+            pipe_ = rs2::pipeline();
+            config_ = rs2::config();
 
             // Verify bag file was created (minimal verification)
             if (!std::filesystem::exists(bag_path_)) {
                 // Recording file not found - this is logged by monitor
             }
+            // clean stop only: check/verify trust the bag without waiting on it
+            else if (!CompletionMarker::write(bag_path_)) {
+                std::cout << "[Realsense] Failed to write completion marker: " << CompletionMarker::pathFor(bag_path_) << "\n";
+            }
 
         } catch (const std::exception&) {
             // Still try to stop the pipeline even if other operations failed
@@ -109,8 +125,8 @@ public:
 
 private:
     void _createConfig() {
-        config_.enable_stream(RS2_STREAM_COLOR, 640, 480, RS2_FORMAT_RGB8, 60);
-        config_.enable_stream(RS2_STREAM_DEPTH, 640, 480, RS2_FORMAT_Z16, 60);
+        config_.enable_stream(RS2_STREAM_COLOR, STREAM_WIDTH, STREAM_HEIGHT, RS2_FORMAT_RGB8, gonfig.realsense_frame_rate);
+        config_.enable_stream(RS2_STREAM_DEPTH, STREAM_WIDTH, STREAM_HEIGHT, RS2_FORMAT_Z16, gonfig.realsense_frame_rate);
 
         std::filesystem::create_directories(std::filesystem::path(bag_path_).parent_path());
         config_.enable_record_to_file(bag_path_);
@@ -27,6 +27,7 @@ private:
 
     std::unique_ptr<RealsenseDevice> device_;
     std::unique_ptr<RealsenseCallback> callback_;
+    std::unique_ptr<FramePool> pool_;  // before buffer_: outlives the leases it holds
     std::unique_ptr<RealsenseBuffer> buffer_;
     std::unique_ptr<RealsenseBroker> broker_;
 
@@ -45,6 +46,11 @@ public:
         device_id_(device_id) {
             device_ = std::make_unique<RealsenseDevice>(device_id);
             callback_ = std::make_unique<RealsenseCallback>();
+            if (gonfig.realsense_frame_pool > 0) {
+                // rgb8 color + z16 depth per slot
+                std::size_t pixels = std::size_t(RealsenseDevice::STREAM_WIDTH) * RealsenseDevice::STREAM_HEIGHT;
+                pool_ = std::make_unique<FramePool>(gonfig.realsense_frame_pool, pixels * 3 + pixels * 2);
+            }
             buffer_ = std::make_unique<RealsenseBuffer>();
             broker_ = std::make_unique<RealsenseBroker>(create_output);
 
@@ -61,10 +67,22 @@ public:
         device_->setup();
 
         // callback
-        callback_->setup(static_cast<void*>(buffer_.get()), static_cast<void*>(realsense_monitor_.get()));
+        callback_->setup(static_cast<void*>(buffer_.get()), static_cast<void*>(realsense_monitor_.get()), pool_.get());
+
+        // buffer
+        buffer_->setCapacity(ringCapacity(gonfig.realsense_frame_rate, gonfig.buffer_headroom_seconds));
+
+        OverflowOptions overflow;
+        overflow.block_timeout = std::chrono::milliseconds(gonfig.overflow_block_timeout_ms);
+        overflow.spill_path = gonfig.output_path + "realsense/overflow.spill";
+        if (!buffer_->setOverflowPolicy(parseOverflowPolicy(gonfig.realsense_overflow_policy), overflow)) {
+            std::cout << "[Realsense] Overflow policy '" << gonfig.realsense_overflow_policy << "' unavailable, using drop_newest\n";
+        }
 
         // broker
-        broker_->setup(buffer_.get(), reinterpret_cast<void*>(&RealsenseBuffer::dequeue));
+        broker_->setup(buffer_.get());
+        broker_->setBatchInterval(gonfig.realsense_frame_rate, std::chrono::milliseconds(gonfig.broker_batch_interval_ms));
+        broker_->setCounters(&realsense_monitor_->counters());
 
         // flag
         is_setup_.store(true);
@@ -77,6 +95,7 @@ public:
         // Start realsense monitor
         realsense_monitor_->start();
 
+        callback_->arm();
         device_->warmup();
         callback_->warmup();
 
@@ -109,9 +128,12 @@ public:
         try {
             realsense_monitor_->onRecordingStop();
 
-            // Stop broker and buffer first to close gate
-            broker_->stop();
+            // Close the gate first, then let the broker write out what is still queued
             buffer_->stop();
+            broker_->stop();
+            buffer_->discardRemaining();
+
+            _logBuffer();
 
             // Then stop device
             if (!device_->stop()) {
@@ -146,18 +168,19 @@ public:
         callback_.reset();
         buffer_.reset();
         broker_.reset();
+        pool_.reset();
 
         realsense_monitor_.reset();
 
         return true;
     }
 
-    bool check() override {
-        return checker_->check();
+    bool check(std::ostream& log) override {
+        return checker_->check(log);
     }
 
-    bool verify() override {
-        return verifier_->verify();
+    bool verify(TaskPool& pool, std::ostream& log) override {
+        return verifier_->verify(pool, log);
     }
 
     std::string __name__() const override {
@@ -165,6 +188,74 @@ public:
     }
 
 private:
+    void _logBuffer() {
+        std::size_t capacity = buffer_->capacity();
+        std::size_t high_watermark = buffer_->highWatermark();
+
+        const Histogram& occupancy = buffer_->occupancyHistogram();
+        const Histogram& delay = buffer_->delayHistogram();
+        const Histogram& batch_time = broker_->batchTimeHistogram();
+
+        std::cout << "[Realsense] Buffer capacity: " << capacity
+                  << " (" << gonfig.buffer_headroom_seconds << "s @ " << gonfig.realsense_frame_rate << "Hz)"
+                  << ", high watermark: " << high_watermark
+                  << " (" << (capacity ? high_watermark * 100 / capacity : 0) << "%)\n";
+        std::cout << "[Realsense] Queueing delay (us) - p50: " << delay.quantile(0.50)
+                  << ", p99: " << delay.quantile(0.99)
+                  << ", max: " << delay.maximum()
+                  << "; batch write (us) - p50: " << batch_time.quantile(0.50)
+                  << ", p99: " << batch_time.quantile(0.99)
+                  << ", max: " << batch_time.maximum() << "\n";
+
+        const AsyncWriter& writer = broker_->writer();
+        std::cout << "[Realsense] File writer - " << writer.bytesWritten() / 1024 << " KB written"
+                  << ", write (us) p99: " << writer.writeTimeHistogram().quantile(0.99)
+                  << ", max: " << writer.writeTimeHistogram().maximum()
+                  << ", stalls: " << writer.stalls()
+                  << (writer.failed() ? ", WRITE FAILED" : "") << "\n";
+
+        OverflowStats stats = buffer_->overflowStats();
+        if (stats.any()) {
+            std::cout << "[Realsense] Buffer overflow (" << overflowPolicyName(buffer_->overflowPolicy()) << ")"
+                      << " - dropped newest: " << stats.dropped_newest
+                      << ", dropped oldest: " << stats.dropped_oldest
+                      << ", blocked: " << stats.blocked
+                      << ", spilled: " << stats.spilled
+                      << ", discarded: " << stats.discarded << "\n";
+        }
+
+        if (pool_) {
+            std::cout << "[Realsense] Frame pool - " << pool_->slotCount() << " slots of " << pool_->slotSize() / 1024 << " KB"
+                      << ", peak in use: " << pool_->peakInUse()
+                      << ", exhausted: " << pool_->exhausted()
+                      << (pool_->exhausted() ? " (kept SDK frames)" : "") << "\n";
+        }
+
+        // full histograms for the session
+        std::ofstream log(gonfig.output_path + "realsense/buffer.log");
+        if (!log.is_open()) return;
+
+        log << "time_to_first_frame_ms " << callback_->timeToFirstFrame() << "\n";
+        log << "capacity " << capacity << "\n";
+        log << "overflow_policy " << overflowPolicyName(buffer_->overflowPolicy()) << "\n";
+        log << "dropped_newest " << stats.dropped_newest << "\n";
+        log << "dropped_oldest " << stats.dropped_oldest << "\n";
+        log << "blocked " << stats.blocked << "\n";
+        log << "spilled " << stats.spilled << "\n";
+        log << "discarded " << stats.discarded << "\n";
+        occupancy.write(log, "occupancy");
+        delay.write(log, "queueing_delay_us");
+        broker_->batchSizeHistogram().write(log, "batch_size");
+        batch_time.write(log, "batch_write_us");
+        log << "writer_stalls " << writer.stalls() << "\n";
+        writer.writeTimeHistogram().write(log, "file_write_us");
+        if (pool_) {
+            log << "frame_pool_slots " << pool_->slotCount() << "\n";
+            log << "frame_pool_peak_in_use " << pool_->peakInUse() << "\n";
+            log << "frame_pool_exhausted " << pool_->exhausted() << "\n";
+        }
+    }
+
     void _monitor() {
         mt_thread_ = std::thread([this]() {
             while (monitor_in_progress_.load()) {
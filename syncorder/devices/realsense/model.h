@@ -2,18 +2,90 @@
 
 #include <librealsense2/rs.hpp>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// local
+#include <syncorder/devices/common/frame_pool.h>
+
+
+/**
+ * @struct RealsenseFrameInfo
+ * Metadata of one video frame plus a view of its pixels, which live either
+ * in the SDK frame or in a pooled slab slot owned by the same buffer item.
+ */
+
+struct RealsenseFrameInfo {
+    double timestamp = 0.0;
+    std::uint64_t frame_number = 0;
+    int width = 0;
+    int height = 0;
+    int bytes_per_pixel = 0;
+    int stride = 0;
+    float depth_units = 0.0f;       // meters per unit, depth only
+    const void* data = nullptr;
+    std::size_t size = 0;
+
+    explicit operator bool() const { return data != nullptr; }
+
+    static RealsenseFrameInfo from(const rs2::video_frame& frame) {
+        RealsenseFrameInfo info;
+        info.timestamp = frame.get_timestamp();
+        info.frame_number = frame.get_frame_number();
+        info.width = frame.get_width();
+        info.height = frame.get_height();
+        info.bytes_per_pixel = frame.get_bytes_per_pixel();
+        info.stride = frame.get_stride_in_bytes();
+        info.data = frame.get_data();
+        info.size = static_cast<std::size_t>(frame.get_data_size());
+        return info;
+    }
+};
 
 
 /**
  * @struct RealsenseBufferData
+ * Either holds the SDK frames (default) or, with a frame pool, a copy of
+ * both payloads in one slab slot so the SDK frames are released at once.
  */
 
 struct RealsenseBufferData {
     rs2::frame color_frame;
     rs2::frame depth_frame;
+    FramePool::Lease slab;
+
+    RealsenseFrameInfo color;
+    RealsenseFrameInfo depth;
+    double arrival = 0.0;  // host ms (system clock) when the callback got the frameset
 
     RealsenseBufferData() = default;
 
-    RealsenseBufferData(const rs2::frame& color, const rs2::frame& depth)
-        : color_frame(color), depth_frame(depth) {}
-};
\ No newline at end of file
+    RealsenseBufferData(const rs2::video_frame& color_in, const rs2::depth_frame& depth_in)
+        : color_frame(color_in), depth_frame(depth_in),
+          color(RealsenseFrameInfo::from(color_in)), depth(RealsenseFrameInfo::from(depth_in)) {
+        depth.depth_units = depth_in.get_units();
+    }
+
+    // copies both payloads into lease; false (and nothing kept) if they do not fit
+    static bool copyInto(RealsenseBufferData& out, FramePool::Lease lease,
+                         const rs2::video_frame& color_in, const rs2::depth_frame& depth_in) {
+        RealsenseFrameInfo color_info = RealsenseFrameInfo::from(color_in);
+        RealsenseFrameInfo depth_info = RealsenseFrameInfo::from(depth_in);
+        depth_info.depth_units = depth_in.get_units();
+
+        if (!lease || color_info.size + depth_info.size > lease.size()) return false;
+
+        std::uint8_t* slot = lease.data();
+        std::memcpy(slot, color_info.data, color_info.size);
+        std::memcpy(slot + color_info.size, depth_info.data, depth_info.size);
+        color_info.data = slot;
+        depth_info.data = slot + color_info.size;
+
+        out.color_frame = rs2::frame();
+        out.depth_frame = rs2::frame();
+        out.slab = std::move(lease);
+        out.color = color_info;
+        out.depth = depth_info;
+        return true;
+    }
+};
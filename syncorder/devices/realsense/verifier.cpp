@@ -12,6 +12,8 @@
 // local
 #include <syncorder/gonfig/gonfig.h>
 #include <syncorder/devices/common/verifier_base.h>
+#include <syncorder/devices/common/completion_marker.h>
+#include <syncorder/io/csv_scanner.h>
 
 
 /**
@@ -46,11 +48,14 @@ public:
     ~RealsenseVerifier() = default;
 
 public:
-    bool verify() override {
-        std::cout << "[Realsense] Starting verification\n";
+    bool verify(TaskPool& pool, std::ostream& log) override {
+        pool_ = &pool;
+        log_ = &log;
+        _log() << "[Realsense] Starting verification\n";
 
         result_ = true;
         video_results_.clear();
+        cache_.load(gonfig.verified_path + "realsense_verify_cache.log", gonfig.verify_rebuild);
 
         // Collect all sessions with their timing data and file paths
         struct SessionData {
@@ -63,6 +68,7 @@ public:
         std::vector<SessionData> sessions;
 
         // Scan for session directories
+        std::vector<SessionData> candidates;
         for (const auto& entry : std::filesystem::directory_iterator(output_path_)) {
             if (!entry.is_directory()) continue;
 
@@ -72,10 +78,15 @@ public:
             SessionData session;
             session.session_name = dir_name;
             session.session_path = entry.path().generic_string();
+            candidates.push_back(session);
+        }
+
+        _runEach(candidates.size(), [&](std::size_t i, std::ostream& task_log) {
+            SessionData& session = candidates[i];
 
             // Parse frame_timing.log from this session
             std::string timing_path = session.session_path + "/frame_timing.log";
-            session.timing = _parseFrameTiming(timing_path);
+            session.timing = _parseFrameTiming(timing_path, task_log);
 
             // Find Realsense CSV and directory in this session
             std::string realsense_path = session.session_path + "/realsense";
@@ -90,14 +101,17 @@ public:
             }
 
             if (session.timing.valid && !session.csv_path.empty()) {
-                sessions.push_back(session);
-                std::cout << "[Realsense] Found session: " << dir_name << " with "
-                          << session.timing.videos.size() << " video(s)\n";
+                task_log << "[Realsense] Found session: " << session.session_name << " with "
+                         << session.timing.videos.size() << " video(s)\n";
             }
+        });
+
+        for (auto& session : candidates) {
+            if (session.timing.valid && !session.csv_path.empty()) sessions.push_back(std::move(session));
         }
 
         if (sessions.empty()) {
-            std::cout << "[Realsense] Error: No valid sessions found\n";
+            _log() << "[Realsense] Error: No valid sessions found\n";
             result_ = false;
             return result_;
         }
@@ -119,13 +133,13 @@ public:
                 info.csv_path = session.csv_path;
                 info.realsense_path = session.realsense_path;
                 latest_videos[video.video_index] = info;
-                std::cout << "[Realsense] Video " << video.video_index
-                          << " from session " << session.session_name << "\n";
+                _log() << "[Realsense] Video " << video.video_index
+                       << " from session " << session.session_name << "\n";
             }
         }
 
-        std::cout << "[Realsense] Using " << latest_videos.size()
-                  << " video(s) from latest recordings\n";
+        _log() << "[Realsense] Using " << latest_videos.size()
+               << " video(s) from latest recordings\n";
 
         // Verify each video with its corresponding CSV file
         bool csv_result = _verifyCsvsByVideoIndividually(latest_videos);
@@ -136,7 +150,11 @@ public:
         result_ = csv_result;
         _writeResult();
 
-        std::cout << "[Realsense] Verify phase " << (result_ ? "completed" : "failed") << "\n";
+        if (!cache_.save()) {
+            _log() << "[Realsense] Failed to write verification cache\n";
+        }
+
+        _log() << "[Realsense] Verify phase " << (result_ ? "completed" : "failed") << "\n";
 
         return result_;
     }
@@ -151,36 +169,64 @@ private:
     bool _verifyCsvsByVideoIndividually(const std::map<int, VideoSessionInfo>& video_sessions) {
         bool all_valid = true;
 
+        // each session CSV is read once, however many videos it covers, all of them in parallel,
+        // unless the cache has it
+        std::vector<CachedFile> files;
+        std::map<std::string, std::size_t> path_slot;
+        for (const auto& [video_index, info] : video_sessions) {
+            auto inserted = path_slot.emplace(info.csv_path, files.size());
+            if (inserted.second) {
+                files.emplace_back();
+                files.back().path = info.csv_path;
+            }
+            files[inserted.first->second].windows.push_back({info.video.start_time, info.video.end_time});
+        }
+
+        _reuseOrRead(files, [this](CachedFile& file, std::ostream& task_log) {
+            SampleTimeline timeline;
+            if (!_loadCsvTimeline(file.path, timeline, task_log)) return;
+
+            for (const auto& range : file.windows) {
+                file.entry.windows[range] = timeline.window(range.first, range.second);
+            }
+            file.ready = true;
+        });
+
         for (const auto& [video_index, info] : video_sessions) {
             RealsenseVideoResult result;
             result.video_name = info.video.getVideoName();
             result.duration = info.video.getDuration();
-            result.expected_frames = (int)(result.duration * 60); // 60fps
+            result.expected_frames = (int)(result.duration * gonfig.realsense_frame_rate);
 
-            std::cout << "\n[Realsense] Processing " << result.video_name
-                      << " from CSV: " << info.csv_path << "\n";
+            _log() << "\n[Realsense] Processing " << result.video_name
+                   << " from CSV: " << info.csv_path << "\n";
 
-            // Process CSV file for this specific video
-            if (!_processCsvFileForVideo(info.csv_path, info.video, result)) {
-                std::cout << "[Realsense] Failed to process CSV for " << result.video_name << "\n";
+            const CachedFile& file = files[path_slot[info.csv_path]];
+            if (!file.ready) {
+                _log() << "[Realsense] Failed to process CSV for " << result.video_name << "\n";
                 result.valid = false;
                 all_valid = false;
             } else {
-                std::cout << "  Duration: " << result.duration << "s\n";
-                std::cout << "  Total frames: " << result.total_frames << "\n";
-                std::cout << "  Expected frames: " << result.expected_frames << "\n";
-                std::cout << "  Capturing success frames: " << result.capturing_success_frames << "\n";
+                SampleTimeline::Window window;
+                file.entry.findWindow(info.video.start_time, info.video.end_time, window);
+                result.total_frames = window.total;
+                result.capturing_success_frames = window.total;
+
+                _log() << "  Duration: " << result.duration << "s\n";
+                _log() << "  Total frames: " << result.total_frames << "\n";
+                _log() << "  Expected frames: " << result.expected_frames << "\n";
+                _log() << "  Capturing success frames: " << result.capturing_success_frames << "\n";
 
                 // Validation: check if total rows match expected frames (with tolerance)
                 if (result.total_frames < result.expected_frames * 0.95) {
-                    std::cout << "  CSV Status: FAILED (insufficient frames)\n";
+                    _log() << "  CSV Status: FAILED (insufficient frames)\n";
                     result.valid = false;
                     all_valid = false;
                 } else if (result.total_frames > result.expected_frames * 1.1) {
-                    std::cout << "  CSV Status: WARNING (too many frames)\n";
+                    _log() << "  CSV Status: WARNING (too many frames)\n";
                     result.valid = true; // Still valid but with warning
                 } else {
-                    std::cout << "  CSV Status: PASSED\n";
+                    _log() << "  CSV Status: PASSED\n";
                     result.valid = true;
                 }
             }
@@ -191,279 +237,165 @@ private:
         return all_valid;
     }
 
-    bool _processCsvFileForVideo(const std::string& csv_path, const VideoTimingData& video,
-                                  RealsenseVideoResult& result) {
+    // frame times (seconds) of every parsable row
+    bool _loadCsvTimeline(const std::string& csv_path, SampleTimeline& timeline, std::ostream& log) {
         if (!std::filesystem::exists(csv_path)) {
-            std::cout << "[Realsense] CSV file does not exist: " << csv_path << "\n";
+            log << "[Realsense] CSV file does not exist: " << csv_path << "\n";
             return false;
         }
 
         try {
-            std::ifstream file(csv_path);
-            std::string line;
-
-            // Read and verify header
-            if (!std::getline(file, line)) {
-                std::cout << "[Realsense] Could not read header\n";
+            CsvScanner scanner;
+            if (!scanner.open(csv_path)) {
+                log << "[Realsense] Could not open CSV file: " << csv_path << "\n";
                 return false;
             }
 
-            if (line.empty() || line.find("index") == std::string::npos) {
-                std::cout << "[Realsense] Invalid CSV header format\n";
+            // Read and verify header
+            std::string_view header = scanner.header();
+            if (header.empty() || header.find("index") == std::string_view::npos) {
+                log << "[Realsense] Invalid CSV header format\n";
                 return false;
             }
 
-            // Parse CSV rows for this specific video based on timestamp
-            while (std::getline(file, line)) {
-                if (line.empty()) continue;
-
-                // Parse timestamp from CSV (format: index,color_timestamp,...)
-                std::istringstream iss(line);
-                std::string index_str, timestamp_str;
-                std::getline(iss, index_str, ',');
-                std::getline(iss, timestamp_str, ',');
+            // only color_timestamp is needed (format: index,color_timestamp,...)
+            scanner.select({1});
+            timeline.times.reserve(scanner.fileSize() / 64);
 
+            while (scanner.next()) {
                 double frame_timestamp = 0.0;
-                try {
-                    frame_timestamp = std::stod(timestamp_str);
-                } catch (...) {
+                if (!CsvScanner::parse(scanner.field(0), frame_timestamp)) {
                     continue; // Skip invalid rows
                 }
 
                 // Convert timestamp from milliseconds to seconds
-                double frame_time_sec = frame_timestamp / 1000.0;
-
-                // Check if this frame belongs to this specific video
-                if (frame_time_sec >= video.start_time && frame_time_sec <= video.end_time) {
-                    result.total_frames++;
-                    result.capturing_success_frames++;
-                }
+                timeline.add(frame_timestamp / 1000.0);
             }
 
+            timeline.finish();
+            log << "[Realsense] Indexed " << timeline.size() << " frames from " << csv_path << "\n";
             return true;
 
         } catch (const std::exception& e) {
-            std::cout << "[Realsense] CSV processing failed: " << e.what() << "\n";
+            log << "[Realsense] CSV processing failed: " << e.what() << "\n";
             return false;
         }
     }
 
     void _verifyBagFilesIndividually(const std::map<int, VideoSessionInfo>& video_sessions) {
-        for (auto& result : video_results_) {
+        // bag per video first; sessions share one bag, so each distinct file is checked once
+        std::vector<std::string> bags;
+        std::map<std::string, std::size_t> bag_slot;
+        std::vector<std::size_t> result_slot(video_results_.size(), SIZE_MAX);
+
+        for (std::size_t r = 0; r < video_results_.size(); ++r) {
+            auto& result = video_results_[r];
+
             // Extract video_index from video_name (e.g., "VIDEO_INDEX_1" -> 1)
             std::string video_name = result.video_name;
             size_t underscore_pos = video_name.rfind('_');
             if (underscore_pos == std::string::npos) {
-                std::cout << "[Realsense] Invalid video name format: " << video_name << "\n";
-                result.bag_valid = false;
+                _log() << "[Realsense] Invalid video name format: " << video_name << "\n";
                 continue;
             }
 
             int video_index = std::stoi(video_name.substr(underscore_pos + 1));
             auto it = video_sessions.find(video_index);
             if (it == video_sessions.end()) {
-                std::cout << "[Realsense] Video session info not found for " << video_name << "\n";
-                result.bag_valid = false;
+                _log() << "[Realsense] Video session info not found for " << video_name << "\n";
                 continue;
             }
 
             // Find any .bag file in the realsense directory
             // BAG files are named with timestamps (e.g., 1760941214.bag)
             std::string bag_path;
-            bool bag_found = false;
 
             if (std::filesystem::exists(it->second.realsense_path)) {
                 for (const auto& entry : std::filesystem::directory_iterator(it->second.realsense_path)) {
                     if (entry.is_regular_file() && entry.path().extension().string() == ".bag") {
                         bag_path = entry.path().generic_string();
-                        bag_found = true;
                         break;
                     }
                 }
             }
 
-            if (bag_found) {
-                result.bag_valid = _verifyBag(bag_path);
-            } else {
-                std::cout << "[Realsense] BAG file not found in: " << it->second.realsense_path << "\n";
-                result.bag_valid = false;
-            }
-
-            // Overall validity requires both CSV and BAG to be valid
-            result.valid = result.valid && result.bag_valid;
-        }
-    }
-
-    bool _verifyCsvsByVideo(const std::vector<std::string>& csv_paths, const FrameTimingData& timing) {
-        // Initialize result for each video
-        std::map<int, RealsenseVideoResult> video_results_map;
-        for (const auto& video : timing.videos) {
-            RealsenseVideoResult result;
-            result.video_name = video.getVideoName();
-            result.duration = video.getDuration();
-            result.expected_frames = (int)(result.duration * 60); // 60fps
-            video_results_map[video.video_index] = result;
-        }
-
-        // Process all CSV files
-        for (const auto& csv_path : csv_paths) {
-            if (!_processCsvFile(csv_path, timing, video_results_map)) {
-                return false;
-            }
-        }
-
-        // Validate each video and store results
-        bool all_valid = true;
-        for (auto& [video_index, result] : video_results_map) {
-            std::cout << "\n[Realsense] " << result.video_name << ":\n";
-            std::cout << "  Duration: " << result.duration << "s\n";
-            std::cout << "  Total frames: " << result.total_frames << "\n";
-            std::cout << "  Expected frames: " << result.expected_frames << "\n";
-            std::cout << "  Capturing success frames: " << result.capturing_success_frames << "\n";
-
-            // Validation: check if total rows match expected frames (with tolerance)
-            if (result.total_frames < result.expected_frames * 0.95) {
-                std::cout << "  CSV Status: FAILED (insufficient frames)\n";
-                result.valid = false;
-                all_valid = false;
-            } else if (result.total_frames > result.expected_frames * 1.1) {
-                std::cout << "  CSV Status: WARNING (too many frames)\n";
-                result.valid = true; // Still valid but with warning
-            } else {
-                std::cout << "  CSV Status: PASSED\n";
-                result.valid = true;
+            if (bag_path.empty()) {
+                _log() << "[Realsense] BAG file not found in: " << it->second.realsense_path << "\n";
+                continue;
             }
 
-            video_results_.push_back(result);
+            auto inserted = bag_slot.emplace(bag_path, bags.size());
+            if (inserted.second) bags.push_back(bag_path);
+            result_slot[r] = inserted.first->second;
         }
 
-        return all_valid;
-    }
+        // completion marker first; only deep mode or a bag without a matching one needs the SDK open
+        std::vector<char> bag_valid(bags.size(), 0);
+        std::vector<CachedFile> opens;
+        std::vector<std::size_t> opened_bag;  // opens[i] is bags[opened_bag[i]]
 
-    bool _processCsvFile(const std::string& csv_path, const FrameTimingData& timing,
-                         std::map<int, RealsenseVideoResult>& video_results_map) {
-        std::cout << "[Realsense] Processing CSV file: " << csv_path << "\n";
+        for (std::size_t b = 0; b < bags.size(); ++b) {
+            CompletionMarker::State state = _checkBagMarker(bags[b], _log());
+            bag_valid[b] = (state == CompletionMarker::State::Complete);
+            if (bag_valid[b] && !gonfig.verify_deep) continue;
 
-        if (!std::filesystem::exists(csv_path)) {
-            std::cout << "[Realsense] File does not exist\n";
-            return false;
+            opens.emplace_back();
+            opens.back().path = bags[b];
+            opened_bag.push_back(b);
         }
 
-        try {
-            std::ifstream file(csv_path);
-            std::string line;
-
-            // Read and verify header
-            if (!std::getline(file, line)) {
-                std::cout << "[Realsense] Could not read header\n";
-                return false;
-            }
-
-            // No need to validate specific header format, just check it's not empty
-            if (line.empty() || line.find("index") == std::string::npos) {
-                std::cout << "[Realsense] Invalid CSV header format\n";
-                return false;
-            }
-
-            // Parse CSV rows and assign to videos based on timestamp
-            while (std::getline(file, line)) {
-                if (line.empty()) continue;
-
-                // Parse timestamp from CSV (format: index,color_timestamp,...)
-                std::istringstream iss(line);
-                std::string index_str, timestamp_str;
-                std::getline(iss, index_str, ',');
-                std::getline(iss, timestamp_str, ',');
-
-                double frame_timestamp = 0.0;
-                try {
-                    frame_timestamp = std::stod(timestamp_str);
-                } catch (...) {
-                    continue; // Skip invalid rows
-                }
-
-                // Convert timestamp from milliseconds to seconds
-                double frame_time_sec = frame_timestamp / 1000.0;
-
-                // Find which video this frame belongs to
-                for (const auto& video : timing.videos) {
-                    if (frame_time_sec >= video.start_time && frame_time_sec <= video.end_time) {
-                        auto& result = video_results_map[video.video_index];
-                        result.total_frames++;
-                        result.capturing_success_frames++;
-                        break;
-                    }
-                }
-            }
-
-            return true;
+        // entry.value: bag opened fine
+        _reuseOrRead(opens, [this](CachedFile& bag, std::ostream& task_log) {
+            bag.entry.value = _openBag(bag.path, task_log) ? 1 : 0;
+            bag.ready = true;
+        });
 
-        } catch (const std::exception& e) {
-            std::cout << "[Realsense] CSV processing failed: " << e.what() << "\n";
-            return false;
+        for (std::size_t i = 0; i < opens.size(); ++i) {
+            bag_valid[opened_bag[i]] = (opens[i].entry.value != 0);
         }
-    }
 
-    void _verifyBagFiles(const std::vector<std::string>& realsense_paths, const FrameTimingData& timing) {
-        // For each video, verify corresponding BAG file in all realsense paths
-        for (auto& result : video_results_) {
-            // BAG files should be named like VIDEO_INDEX_1.bag
-            std::string bag_filename = result.video_name + ".bag";
-            bool bag_found = false;
-
-            for (const auto& realsense_path : realsense_paths) {
-                std::string bag_path = realsense_path + "/" + bag_filename;
-                if (std::filesystem::exists(bag_path)) {
-                    result.bag_valid = _verifyBag(bag_path);
-                    bag_found = true;
-                    break;
-                }
-            }
-
-            if (!bag_found) {
-                std::cout << "[Realsense] Warning: BAG file not found for " << result.video_name << "\n";
-                result.bag_valid = false;
-            }
+        for (std::size_t r = 0; r < video_results_.size(); ++r) {
+            auto& result = video_results_[r];
+            result.bag_valid = (result_slot[r] != SIZE_MAX) && bag_valid[result_slot[r]] != 0;
 
             // Overall validity requires both CSV and BAG to be valid
             result.valid = result.valid && result.bag_valid;
         }
     }
 
-    bool _verifyBag(const std::string& bag_path) {
-        std::cout << "[Realsense] Verifying BAG file: " << bag_path << "\n";
+    CompletionMarker::State _checkBagMarker(const std::string& bag_path, std::ostream& log) {
+        log << "[Realsense] Verifying BAG file: " << bag_path << "\n";
+
+        std::uint64_t recorded = 0;
+        std::uint64_t current = 0;
+        CompletionMarker::State state = CompletionMarker::check(bag_path, recorded, current);
+
+        switch (state) {
+        case CompletionMarker::State::Complete:
+            log << "[Realsense] Completion marker matches (" << current << " bytes)\n";
+            break;
+        case CompletionMarker::State::Missing:
+            log << "[Realsense] No completion marker, opening with SDK\n";
+            break;
+        case CompletionMarker::State::Mismatch:
+            log << "[Realsense] Completion marker records " << recorded << " bytes, file has " << current << ", opening with SDK\n";
+            break;
+        }
+        return state;
+    }
 
+    bool _openBag(const std::string& bag_path, std::ostream& log) {
         if (!std::filesystem::exists(bag_path)) {
-            std::cout << "[Realsense] File does not exist\n";
+            log << "[Realsense] File does not exist: " << bag_path << "\n";
             return false;
         }
 
         auto file_size = std::filesystem::file_size(bag_path);
-        std::cout << "[Realsense] File size: " << file_size << " bytes\n";
-
         if (file_size == 0) {
-            std::cout << "[Realsense] File is empty\n";
+            log << "[Realsense] File is empty: " << bag_path << "\n";
             return false;
         }
 
-        // Wait for file to stabilize (check if still being written)
-        std::cout << "[Realsense] Checking file stability...\n";
-        auto last_size = file_size;
-        for (int i = 0; i < 10; ++i) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            auto current_size = std::filesystem::file_size(bag_path);
-            if (current_size != last_size) {
-                std::cout << "[Realsense] File size changing, waiting...\n";
-                last_size = current_size;
-            } else {
-                break;
-            }
-            if (i == 9) {
-                std::cout << "[Realsense] File still changing after 1 second\n";
-                return false;
-            }
-        }
-
         // Verify BAG file by attempting to open with RealSense SDK (read-only)
         try {
             rs2::config cfg;
@@ -473,14 +405,14 @@ private:
             pipe.start(cfg);
             pipe.stop();
 
-            std::cout << "[Realsense] BAG file verification successful\n";
+            log << "[Realsense] BAG file verification successful: " << bag_path << "\n";
             return true;
 
         } catch (const rs2::error& e) {
-            std::cout << "[Realsense] RealSense error during BAG verification: " << e.what() << "\n";
+            log << "[Realsense] RealSense error during BAG verification: " << e.what() << "\n";
             return false;
         } catch (const std::exception& e) {
-            std::cout << "[Realsense] BAG verification failed: " << e.what() << "\n";
+            log << "[Realsense] BAG verification failed: " << e.what() << "\n";
             return false;
         }
     }
@@ -494,7 +426,7 @@ private:
         std::ofstream csv(csv_path);
 
         if (!csv.is_open()) {
-            std::cout << "[Realsense] Failed to create result CSV file: " << csv_path << "\n";
+            _log() << "[Realsense] Failed to create result CSV file: " << csv_path << "\n";
             return;
         }
 
@@ -512,6 +444,6 @@ private:
         }
 
         csv.close();
-        std::cout << "[Realsense] Results written to " << csv_path << "\n";
+        _log() << "[Realsense] Results written to " << csv_path << "\n";
     }
 };
@@ -4,6 +4,8 @@
 #include <atomic>
 #include <deque>
 #include <chrono>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -16,60 +18,127 @@
 // local
 #include <syncorder/gonfig/gonfig.h>
 #include <syncorder/error/exception.h>
+#include <syncorder/io/async_writer.h>
+#include <syncorder/gonfig/writer_options.h>
+#include <syncorder/io/csv_formatter.h>
 #include <syncorder/devices/common/broker_base.h>
+#include <syncorder/devices/common/clock_sync.h>
+#include <syncorder/devices/common/first_sample.h>
 #include <syncorder/devices/tobii/model.h>
+#include <syncorder/devices/tobii/gaze_log.cpp>
 
 
 /**
- * @class
+ * @class TSConverter
+ * Maps Tobii timestamps to UTC from the persistent time-sync stream.
+ *
+ * onTimeSync() runs on the SDK's time-sync thread and feeds two estimators:
+ * Tobii system clock -> UTC (a host clock reading bracketed around
+ * tobii_research_get_system_time_stamp) and device clock -> Tobii system
+ * clock (the stream's request/response bracket). Fits are published
+ * lock-free; get_frame_timestamp() never blocks.
  */
 
 class TSConverter {
 private:
     std::atomic<bool> _option_is_enabled;
-    int64_t _boot_utc_offset_us;
-    bool _boot_offset_initialized;
+
+    // sync thread only
+    ClockEstimator _utc_estimator;
+    ClockEstimator _device_estimator;
+
+    PublishedClock _utc_clock;      // tobii system us -> utc us
+    PublishedClock _device_clock;   // device us -> tobii system us
+    FirstSample _first_sync;
 
 public:
     TSConverter() :
-        _option_is_enabled(true),
-        _boot_utc_offset_us(0),
-        _boot_offset_initialized(false)
-    {}
+        _option_is_enabled(true)
+    {
+        _first_sync.arm();
+    }
 
     void enable_global_time(bool enable) {
         _option_is_enabled.store(enable);
     }
 
+    static void onTimeSync(TobiiResearchTimeSynchronizationData* data, void* user_data) {
+        auto* converter = static_cast<TSConverter*>(user_data);
+        if (converter && data) {
+            converter->update_calibration(data->system_request_time_stamp, data->device_time_stamp, data->system_response_time_stamp);
+        }
+    }
+
     void update_calibration(int64_t system_request_us, int64_t device_us, int64_t system_response_us) {
-        if (!_boot_offset_initialized) {
-            _initialize_boot_offset(system_request_us, system_response_us);
+        // device clock against the middle of the system-clock bracket
+        _device_estimator.add(device_us, (system_request_us + system_response_us) / 2, system_response_us - system_request_us);
+        _device_clock.publish(_device_estimator.fit());
+
+        // tobii system clock against utc, bracketed the same way
+        int64_t utc_before = _utc_now_us();
+        int64_t system_us = 0;
+        TobiiResearchStatus status = tobii_research_get_system_time_stamp(&system_us);
+        int64_t utc_after = _utc_now_us();
+
+        if (status == TOBII_RESEARCH_STATUS_OK) {
+            _utc_estimator.add(system_us, (utc_before + utc_after) / 2, utc_after - utc_before);
+            _utc_clock.publish(_utc_estimator.fit());
+            _first_sync.signal();
         }
     }
 
-    double get_frame_timestamp(int64_t timestamp_us) {
-        if (_option_is_enabled.load() && _boot_offset_initialized) {
-            double timestamp_ms = timestamp_us / 1000.0;
-            return timestamp_ms + (_boot_utc_offset_us / 1000.0);
-        } else {
-            return static_cast<double>(timestamp_us) / 1000.0;
+    double get_frame_timestamp(int64_t timestamp_us) const {
+        if (_option_is_enabled.load()) {
+            ClockFit fit = _utc_clock.load();
+            if (fit.valid()) return fit.map(timestamp_us) / 1000.0;
         }
+        return static_cast<double>(timestamp_us) / 1000.0;
     }
 
     bool is_ready() const {
-        return _boot_offset_initialized;
+        return _first_sync.received();
+    }
+
+    bool wait_ready(std::chrono::milliseconds timeout) {
+        return _first_sync.wait(timeout);
+    }
+
+    ClockFit utc_fit() const { return _utc_clock.load(); }
+    ClockFit device_fit() const { return _device_clock.load(); }
+
+    // fit taking system_time_stamp (or device_time_stamp) straight to utc; identity until ready
+    ClockFit frame_clock(bool from_device) const {
+        if (!_option_is_enabled.load()) return ClockFit();
+
+        ClockFit utc = _utc_clock.load();
+        if (!from_device) return utc.valid() ? utc : ClockFit();
+
+        ClockFit composed = composeClock(utc, _device_clock.load());
+        return composed.valid() ? composed : ClockFit();
     }
 
 private:
-    void _initialize_boot_offset(int64_t system_request_us, int64_t system_response_us) {
-        auto now_utc = std::chrono::system_clock::now();
-        auto utc_us = std::chrono::duration_cast<std::chrono::microseconds>(
-            now_utc.time_since_epoch()).count();
-        
-        int64_t avg_system_time_us = (system_request_us + system_response_us) / 2;
-        _boot_utc_offset_us = utc_us - avg_system_time_us;
-        
-        _boot_offset_initialized = true;
+    static int64_t _utc_now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+};
+
+
+/**
+ * @struct GazeBatchColumns
+ * Per-batch columns (structure of arrays) computed next to the ring span,
+ * which the broker reads in place: one contiguous array per derived field.
+ */
+
+struct GazeBatchColumns {
+    std::vector<std::int64_t> source_ts;   // us, system or device clock
+    std::vector<double> frame_ts;          // ms, utc
+
+    void resize(std::size_t count) {
+        if (source_ts.size() >= count) return;
+        source_ts.resize(count);
+        frame_ts.resize(count);
     }
 };
 
@@ -80,58 +149,41 @@ private:
 
 class TobiiBroker : public TBBroker<TobiiBufferData> {
 private:
-    std::ofstream csv_;
+    AsyncWriter csv_;
+    CsvFormatter batch_;
     std::string output_;
+    bool create_output_;
+
+    // binary mode (--tobii_output_format binary)
+    bool binary_ = false;
+    GazeLogWriter gaze_log_;
+    std::vector<GazeLogRecord> records_;
 
     TSConverter* converter_;
 
+    // frame_timestamp source (--tobii_timestamp_source): host receive time or device clock
+    static constexpr int CLOCK_LOG_THRESHOLD_US = 10;  // model change that earns a clock_model.log line
+
+    bool device_clock_ = false;
+    AsyncWriter clock_log_;
+    CsvFormatter clock_line_{128};
+    ClockFit logged_clock_;
+    bool clock_logged_ = false;
+    GazeBatchColumns columns_;
+
     // for csv
     size_t index_ = 0;
 
 public:
-    TobiiBroker(bool create_output) {
+    TobiiBroker(bool create_output)
+    :
+        create_output_(create_output)
+    {
         output_ = gonfig.output_path + "tobii/";
-
-        if (create_output) {
-            std::filesystem::create_directories(output_);
-
-            csv_.open(output_ + "tobii_data.csv");
-            csv_
-                <<"index,"
-
-                <<"frame_timestamp,"
-                <<"frame_hardware_timestamp,"
-
-                <<"left_gaze_display_x,"
-                <<"left_gaze_display_y,"
-                <<"left_gaze_3d_x,"
-                <<"left_gaze_3d_y,"
-                <<"left_gaze_3d_z,"
-                <<"left_gaze_validity,"
-
-                <<"left_gaze_origin_x,"
-                <<"left_gaze_origin_y,"
-                <<"left_gaze_origin_z,"
-                <<"left_gaze_origin_validity,"
-
-                <<"left_pupil_diameter,"
-                <<"left_pupil_validity,"
-
-                <<"right_gaze_display_x,"
-                <<"right_gaze_display_y,"
-                <<"right_gaze_3d_x,"
-                <<"right_gaze_3d_y,"
-                <<"right_gaze_3d_z,"
-                <<"right_gaze_validity,"
-
-                <<"right_gaze_origin_x,"
-                <<"right_gaze_origin_y,"
-                <<"right_gaze_origin_z,"
-                <<"right_gaze_origin_validity,"
-
-                <<"right_pupil_diameter,"
-                <<"right_pupil_validity\n";
-        }
+        binary_ = (gonfig.tobii_output_format == "binary");
+        device_clock_ = (gonfig.tobii_timestamp_source == "device");
+        records_.reserve(BATCH_SIZE);
+        columns_.resize(BATCH_SIZE);
     }
     ~TobiiBroker() {}
 
@@ -139,61 +191,107 @@ public:
     void pre_setup(TSConverter* converter) {
         converter_ = converter;
         converter_->enable_global_time(true);
+
+        // after device setup: the gaze log header carries the rate actually set
+        if (create_output_) _openOutput();
     }
 
     void cleanup() {
-        csv_.flush();
+        clock_log_.close();
+        if (binary_) {
+            gaze_log_.close();
+            return;
+        }
         csv_.close();
     }
 
+    const AsyncWriter& writer() const {
+        return binary_ ? gaze_log_.writer() : csv_;
+    }
+
 protected:
     void _process(const TobiiBufferData& data) override {
-        _write(data);
+        _processBatch(&data, 1);
+    }
+
+    void _processBatch(const TobiiBufferData* data, std::size_t count) override {
+        // one clock model per batch, mapped over a contiguous array of source timestamps
+        ClockFit clock = converter_->frame_clock(device_clock_);
+
+        columns_.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            columns_.source_ts[i] = device_clock_ ? data[i].device_time_stamp : data[i].system_time_stamp;
+        }
+        _logClock(clock, columns_.source_ts[0]);
+        mapClockBatch(clock, columns_.source_ts.data(), columns_.frame_ts.data(), count);
+
+        std::uint64_t first_index = index_;
+        index_ += count;
+
+        // one hand-off to the writer thread per batch
+        if (binary_) {
+            records_.clear();
+            for (std::size_t i = 0; i < count; ++i) {
+                records_.push_back(toGazeLogRecord(first_index + i, columns_.frame_ts[i], data[i]));
+            }
+            gaze_log_.write(records_.data(), records_.size());
+            return;
+        }
+
+        // csv rows straight from the ring span, no intermediate record
+        for (std::size_t i = 0; i < count; ++i) {
+            writeGazeCsvRow(batch_, first_index + i, columns_.frame_ts[i], data[i]);
+        }
+        csv_.write(batch_.data(), batch_.size());
+        batch_.clear();
     }
 
 private:
-    void _write(const TobiiBufferData& data) {
-        std::ostringstream system_time_stamp;
-        system_time_stamp << std::fixed << std::setprecision(14) << converter_->get_frame_timestamp(data.gazed.system_time_stamp);
-
-        csv_
-            << index_ << ","
-
-            << system_time_stamp.str() << ","
-            << data.gazed.device_time_stamp << ","
-
-            << data.gazed.left_eye.gaze_point.position_on_display_area.x << ","
-            << data.gazed.left_eye.gaze_point.position_on_display_area.y << ","
-            << data.gazed.left_eye.gaze_point.position_in_user_coordinates.x << ","
-            << data.gazed.left_eye.gaze_point.position_in_user_coordinates.y << ","
-            << data.gazed.left_eye.gaze_point.position_in_user_coordinates.z << ","
-            << data.gazed.left_eye.gaze_point.validity << ","
-            
-            << data.gazed.left_eye.gaze_origin.position_in_user_coordinates.x << ","
-            << data.gazed.left_eye.gaze_origin.position_in_user_coordinates.y << ","
-            << data.gazed.left_eye.gaze_origin.position_in_user_coordinates.z << ","
-            << data.gazed.left_eye.gaze_origin.validity << ","
-
-            << data.gazed.left_eye.pupil_data.diameter << ","
-            << data.gazed.left_eye.pupil_data.validity << ","
-
-            << data.gazed.right_eye.gaze_point.position_on_display_area.x << ","
-            << data.gazed.right_eye.gaze_point.position_on_display_area.y << ","
-            << data.gazed.right_eye.gaze_point.position_in_user_coordinates.x << ","
-            << data.gazed.right_eye.gaze_point.position_in_user_coordinates.y << ","
-            << data.gazed.right_eye.gaze_point.position_in_user_coordinates.z << ","
-            << data.gazed.right_eye.gaze_point.validity << ","
-
-            << data.gazed.right_eye.gaze_origin.position_in_user_coordinates.x << ","
-            << data.gazed.right_eye.gaze_origin.position_in_user_coordinates.y << ","
-            << data.gazed.right_eye.gaze_origin.position_in_user_coordinates.z << ","
-            << data.gazed.right_eye.gaze_origin.validity << ","
-
-            << data.gazed.right_eye.pupil_data.diameter << ","
-            << data.gazed.right_eye.pupil_data.validity << ","
-            
-            << "\n";
-
-        index_++;
+    void _openOutput() {
+        std::filesystem::create_directories(output_);
+
+        if (binary_) {
+            if (!gaze_log_.open(output_ + "tobii_data.gaze", static_cast<std::uint32_t>(gonfig.tobii_sampling_rate), configuredWriterOptions())) {
+                throw TobiiDeviceError("Failed to open " + output_ + "tobii_data.gaze");
+            }
+        } else {
+            if (!csv_.open(output_ + "tobii_data.csv", configuredWriterOptions())) {
+                throw TobiiDeviceError("Failed to open " + output_ + "tobii_data.csv");
+            }
+            csv_.write(GAZE_CSV_HEADER, std::strlen(GAZE_CSV_HEADER));
+        }
+
+        // clock models used for frame_timestamp, from the sample index they first applied to
+        AsyncWriterOptions options;
+        options.buffer_size = 16 * 1024;
+        options.buffer_count = 2;
+        if (clock_log_.open(output_ + "clock_model.log", options)) {
+            clock_log_.write(std::string(device_clock_ ? "# source device_time_stamp\n" : "# source system_time_stamp\n"));
+            clock_log_.write(std::string("# frame_timestamp_ms = (y_ref + offset + skew * (x - x_ref)) / 1000\n"));
+            clock_log_.write("# within " + std::to_string(CLOCK_LOG_THRESHOLD_US) + " us of the model in use\n");
+            clock_log_.write(std::string("from_index x_ref y_ref offset skew points residual_us max_rtt_us\n"));
+        }
+    }
+
+    // logs the model once it maps x more than CLOCK_LOG_THRESHOLD_US away from the last logged one
+    void _logClock(const ClockFit& clock, std::int64_t x) {
+        if (!clock_log_.isOpen()) return;
+        if (clock_logged_ && clock.valid() == logged_clock_.valid()
+            && std::fabs(clock.map(x) - logged_clock_.map(x)) <= CLOCK_LOG_THRESHOLD_US) return;
+
+        CsvFormatter& line = clock_line_;
+        line.clear();
+        line.integer(index_).text(" ")
+            .integer(clock.x_ref).text(" ")
+            .integer(clock.y_ref).text(" ")
+            .fixed(clock.offset, 3).text(" ")
+            .general(clock.skew, 15).text(" ")
+            .integer(clock.points).text(" ")
+            .fixed(clock.residual_us, 1).text(" ")
+            .fixed(clock.rtt_us, 0).text("\n");
+        clock_log_.write(line.data(), line.size());
+
+        logged_clock_ = clock;
+        clock_logged_ = true;
     }
 };
\ No newline at end of file
@@ -17,19 +17,7 @@
 
 /**
  * @class Buffer
+ * Sized at setup from the sampling rate and gonfig.buffer_headroom_seconds.
  */
 
-constexpr std::size_t TOBII_RING_BUFFER_SIZE = 2048;
-
-class TobiiBuffer : public BBuffer<TobiiBufferData, TOBII_RING_BUFFER_SIZE> {
-public:
-    static void* dequeue(void* instance) {
-        auto* buffer = static_cast<TobiiBuffer*>(instance);
-        auto result = buffer->_dequeue();
-        if (!result.has_value()) return nullptr;
-        
-        return new TobiiBufferData(std::move(result.value()));
-    }
-protected:
-    void onOverflow() noexcept override { std::cout << "[Warning] Buffer overflow\n"; }
-};
\ No newline at end of file
+class TobiiBuffer : public BBuffer<TobiiBufferData, DYNAMIC_CAPACITY> {};
\ No newline at end of file
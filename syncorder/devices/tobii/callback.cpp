@@ -7,6 +7,7 @@
 
 // local
 #include <syncorder/devices/tobii/buffer.cpp> //TODO: include buffer
+#include <syncorder/devices/common/first_sample.h>
 #include <syncorder/error/exception.h>
 
 
@@ -20,7 +21,8 @@ private:
     void* buffer_;
 
     // flag
-    std::atomic<bool> first_frame_received_;
+    FirstSample first_frame_;
+    static constexpr std::chrono::milliseconds WARMUP_TIMEOUT{10000};
 
 public:
     TobiiCallback() {}
@@ -30,23 +32,31 @@ public:
     void setup(void* buffer) {
         instance_ = this;
         buffer_ = buffer;
+
+        first_frame_.arm();
+    }
+
+    // restart the time-to-first-sample clock, right before subscribing
+    void arm() {
+        first_frame_.arm();
     }
 
+    // sleeps until the first gaze sample (no spinning)
     bool warmup() {
-        auto start = std::chrono::steady_clock::now();
-        auto end = std::chrono::milliseconds(10000);
-        
-        while (!first_frame_received_.load()) {
-            auto elapsed = std::chrono::steady_clock::now() - start;
-            if (elapsed >= end) {
-                std::cout << "[ERROR] warmup timeout\n";
-                return false;
-            }
+        if (!first_frame_.wait(WARMUP_TIMEOUT)) {
+            std::cout << "[ERROR] warmup timeout\n";
+            return false;
         }
 
+        std::cout << "[Tobii] First sample after " << static_cast<long long>(first_frame_.elapsedMs()) << " ms\n";
         return true;
     }
 
+    // ms from arm() to the first gaze sample, 0 if none arrived
+    double timeToFirstFrame() {
+        return first_frame_.elapsedMs();
+    }
+
     static void onGaze(TobiiResearchGazeData* gaze_data, void* user_data) {
         auto* callback_instance = static_cast<TobiiCallback*>(user_data);
         if (callback_instance) {
@@ -56,20 +66,11 @@ public:
 
 private:
     void _onGaze(TobiiResearchGazeData* gaze_data) {
-        if (!first_frame_received_.load()) first_frame_received_.store(true);
+        first_frame_.signal();
         if (!gaze_data || !buffer_) return;
 
+        // only the persisted fields go into the ring
         auto* tobii_buffer = static_cast<TobiiBuffer*>(buffer_);
-        TobiiBufferData data = _map(gaze_data);
-        tobii_buffer->enqueue(std::move(data));
-    }
-
-private:
-    TobiiBufferData _map(TobiiResearchGazeData* gaze_data) {
-        TobiiBufferData data = {};
-
-        data.gazed = *gaze_data;
-            
-        return data;
+        tobii_buffer->enqueue(toTobiiBufferData(*gaze_data));
     }
 };
\ No newline at end of file
@@ -7,6 +7,9 @@
 // local
 #include <syncorder/gonfig/gonfig.h>
 #include <syncorder/devices/common/checker_base.h>
+#include <syncorder/io/csv_scanner.h>
+#include <syncorder/devices/tobii/gaze_log.cpp>
+#include <syncorder/devices/tobii/session_rate.h>
 
 
 /**
@@ -25,12 +28,14 @@ public:
     ~TobiiChecker() = default;
 
 public:
-    bool check() override {
-        std::cout << "[Tobii] Starting check for flat structure\n";
+    bool check(std::ostream& log) override {
+        log_ = &log;
+        _log() << "[Tobii] Starting check for flat structure\n";
 
         result_ = true;
 
         std::string csv_path = "";
+        std::string gaze_path = "";
 
         // Scan tobii directory
         std::string tobii_path = output_path_ + "/tobii";
@@ -40,102 +45,126 @@ public:
                 for (const auto& entry : std::filesystem::directory_iterator(tobii_path)) {
                     if (entry.is_regular_file()) {
                         auto ext = entry.path().extension().string();
-                        if (ext == ".csv") {
+                        if (ext == ".csv" && csv_path.empty()) {
                             csv_path = entry.path().generic_string();
-                            break;
+                        }
+                        if (ext == ".gaze" && gaze_path.empty()) {
+                            gaze_path = entry.path().generic_string();
                         }
                     }
                 }
             }
 
-            // Verify CSV
-            if (!csv_path.empty()) {
+            // Verify binary log if recorded, else CSV
+            if (!gaze_path.empty()) {
+                if (!_checkGazeLog(gaze_path)) {
+                    result_ = false;
+                }
+            } else if (!csv_path.empty()) {
                 if (!_checkCsv(csv_path)) {
                     result_ = false;
                 }
             } else {
-                std::cout << "[Tobii] Warning: No CSV file found\n";
+                _log() << "[Tobii] Warning: No CSV or gaze log file found\n";
                 result_ = false;
             }
 
         } catch (const std::exception& e) {
-            std::cout << "[Tobii] Check error: " << e.what() << "\n";
+            _log() << "[Tobii] Check error: " << e.what() << "\n";
             result_ = false;
         }
 
         _writeResult();
 
-        std::cout << "[Tobii] Check phase " << (result_ ? "completed" : "failed") << "\n";
+        _log() << "[Tobii] Check phase " << (result_ ? "completed" : "failed") << "\n";
         return result_;
     }
 
 private:
     bool _checkCsv(const std::string& csv_path) {
-        std::cout << "[Tobii] Verifying file: " << csv_path << "\n";
+        _log() << "[Tobii] Verifying file: " << csv_path << "\n";
 
         if (!std::filesystem::exists(csv_path)) {
-            std::cout << "[Tobii] File does not exist\n";
+            _log() << "[Tobii] File does not exist\n";
             return false;
         }
 
         auto file_size = std::filesystem::file_size(csv_path);
-        std::cout << "[Tobii] File size: " << file_size << " bytes\n";
+        _log() << "[Tobii] File size: " << file_size << " bytes\n";
 
         if (file_size == 0) {
-            std::cout << "[Tobii] File is empty\n";
+            _log() << "[Tobii] File is empty\n";
             return false;
         }
 
         try {
-            std::ifstream file(csv_path);
-            std::string line;
-            int line_count = 0;
-            bool header_valid = false;
+            CsvScanner scanner;
+            if (!scanner.open(csv_path)) {
+                _log() << "[Tobii] Could not open file\n";
+                return false;
+            }
 
             // Read and verify header
-            if (std::getline(file, line)) {
-                line_count++;
-                std::cout << "[Tobii] First line: " << line << "\n";
-                if (line.find("index,") == 0) {
-                    header_valid = true;
-                } else {
-                    std::cout << "[Tobii] Invalid CSV header format\n";
-                    return false;
-                }
-            } else {
-                std::cout << "[Tobii] Could not read first line\n";
+            std::string_view header = scanner.header();
+            _log() << "[Tobii] First line: " << header << "\n";
+            if (header.find("index,") != 0) {
+                _log() << "[Tobii] Invalid CSV header format\n";
                 return false;
             }
 
-            // Count data rows (excluding header)
-            while (std::getline(file, line)) {
-                if (!line.empty()) {
-                    line_count++;
-                }
+            // Count data rows (excluding header); rows are only counted, never split
+            int data_row_count = static_cast<int>(scanner.countRows());
+
+            // a CSV does not carry its rate; the recorder wrote the one the tracker ran at
+            int rate = recordedSamplingRate(std::filesystem::path(csv_path).parent_path().generic_string());
+            if (rate) {
+                _log() << "[Tobii] Recorded at " << rate << "Hz (buffer.log)\n";
+            } else {
+                rate = gonfig.tobii_sampling_rate;
+                _log() << "[Tobii] No recorded rate in buffer.log, using --tobii_sampling_rate " << rate << "Hz\n";
             }
+            return _checkFrameCount(data_row_count, rate);
+
+        } catch (const std::exception& e) {
+            _log() << "[Tobii] File verification failed: " << e.what() << "\n";
+            return false;
+        }
+    }
 
-            int data_row_count = line_count - 1; // Exclude header
-            int expected_frames = gonfig.record_duration * 60; // 60 fps
+    bool _checkGazeLog(const std::string& gaze_path) {
+        _log() << "[Tobii] Verifying file: " << gaze_path << "\n";
 
-            std::cout << "[Tobii] Data rows: " << data_row_count << "\n";
-            std::cout << "[Tobii] Expected frames (60fps * " << gonfig.record_duration << "s): " << expected_frames << "\n";
+        GazeLogReader reader;
+        if (!reader.open(gaze_path)) {
+            _log() << "[Tobii] Invalid gaze log: " << reader.error() << "\n";
+            return false;
+        }
 
-            if (data_row_count < expected_frames) {
-                std::cout << "[Tobii] Insufficient frames (expected: >=" << expected_frames << ", actual: " << data_row_count << ")\n";
-                return false;
-            }
+        _log() << "[Tobii] Gaze log v" << reader.header().version
+               << ", " << reader.header().sampling_rate << "Hz\n";
 
-            if (data_row_count > expected_frames) {
-                std::cout << "[Tobii] Extra frames recorded: +" << (data_row_count - expected_frames) << " frames (acceptable due to stop timing)\n";
-            }
+        // record count comes straight from the file size; the header has the rate it was recorded at
+        int rate = reader.header().sampling_rate ? static_cast<int>(reader.header().sampling_rate) : gonfig.tobii_sampling_rate;
+        return _checkFrameCount(static_cast<int>(reader.size()), rate);
+    }
 
-            std::cout << "[Tobii] File verification successful\n";
-            return true;
+    bool _checkFrameCount(int data_row_count, int rate) {
+        int expected_frames = gonfig.record_duration * rate;
 
-        } catch (const std::exception& e) {
-            std::cout << "[Tobii] File verification failed: " << e.what() << "\n";
+        _log() << "[Tobii] Data rows: " << data_row_count << "\n";
+        _log() << "[Tobii] Expected frames (" << rate << "Hz * " << gonfig.record_duration << "s): " << expected_frames << "\n";
+
+        if (data_row_count < expected_frames) {
+            _log() << "[Tobii] Insufficient frames (expected: >=" << expected_frames << ", actual: " << data_row_count << ")\n";
             return false;
         }
+
+        if (data_row_count > expected_frames) {
+            _log() << "[Tobii] Extra frames recorded: +" << (data_row_count - expected_frames) << " frames (acceptable due to stop timing)\n";
+        }
+
+        _log() << "[Tobii] File verification successful\n";
+        return true;
     }
 
     void _writeResult() {
@@ -147,7 +176,7 @@ private:
         std::ofstream csv(csv_path);
 
         if (!csv.is_open()) {
-            std::cout << "[Tobii] Failed to create result CSV file: " << csv_path << "\n";
+            _log() << "[Tobii] Failed to create result CSV file: " << csv_path << "\n";
             return;
         }
 
@@ -155,6 +184,6 @@ private:
         csv << result_;
 
         csv.close();
-        std::cout << "[Tobii] Results written to " << csv_path << "\n";
+        _log() << "[Tobii] Results written to " << csv_path << "\n";
     }
 };
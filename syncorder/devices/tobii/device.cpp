@@ -8,6 +8,7 @@
 #include <future>
 #include <thread>  
 #include <memory>
+#include <cmath>
 
 // installed
 #include "tobii_research.h"
@@ -39,6 +40,7 @@ private:
     TobiiResearchTimeSynchronizationData sync_;
     
     bool sync_received_;
+    tobii_research_time_synchronization_data_callback time_sync_ = nullptr;
 
 public:
     TobiiDevice(int device_id = 0) 
@@ -85,6 +87,8 @@ public:
             reinterpret_cast<void(*)(TobiiResearchGazeData*, void*)>(gaze_)
         );
 
+        unsubscribeTimeSync();
+
         return true;
     }
     
@@ -97,14 +101,25 @@ public:
         return device_;
     }
 
-    TobiiResearchTimeSynchronizationData getTime() {
-        return _time();
-    }
-
     TobiiResearchGazeData getGaze() {
         return _gaze();
     }
 
+    // persistent time-sync stream, until unsubscribeTimeSync() or stop
+    void subscribeTimeSync(tobii_research_time_synchronization_data_callback callback, void* user_data) {
+        TobiiResearchStatus status = tobii_research_subscribe_to_time_synchronization_data(device_, callback, user_data);
+        if (status != TOBII_RESEARCH_STATUS_OK) {
+            throw TobiiDeviceError("Failed to subscribe to time synchronization data. Status: " + std::to_string(status));
+        }
+        time_sync_ = callback;
+    }
+
+    void unsubscribeTimeSync() {
+        if (!time_sync_) return;
+        tobii_research_unsubscribe_from_time_synchronization_data(device_, time_sync_);
+        time_sync_ = nullptr;
+    }
+
 private:
     TobiiResearchEyeTracker* _createDevice() {
         TobiiResearchEyeTrackers* devices;
@@ -127,13 +142,37 @@ private:
         return device;
     }
 
+    // gonfig.tobii_sampling_rate, or the nearest rate the tracker supports (written back to gonfig; TobiiManager saves it in buffer.log)
     void _setFrequency() {
         TobiiResearchStatus status;
+        float requested = static_cast<float>(gonfig.tobii_sampling_rate);
+        float frequency = requested;
+
+        TobiiResearchGazeOutputFrequencies* frequencies = nullptr;
+        status = tobii_research_get_all_gaze_output_frequencies(device_, &frequencies);
+        if (status == TOBII_RESEARCH_STATUS_OK && frequencies && frequencies->frequency_count > 0) {
+            std::string supported;
+            frequency = frequencies->frequencies[0];
+            for (size_t i = 0; i < frequencies->frequency_count; ++i) {
+                float candidate = frequencies->frequencies[i];
+                if (std::fabs(candidate - requested) < std::fabs(frequency - requested)) frequency = candidate;
+                supported += (i ? ", " : "") + std::to_string(static_cast<int>(candidate + 0.5f));
+            }
+            tobii_research_free_gaze_output_frequencies(frequencies);
+
+            if (std::fabs(frequency - requested) >= 0.5f) {
+                std::cout << "[Tobii] Warning: " << gonfig.tobii_sampling_rate << "Hz not supported (" << supported
+                          << "), using " << static_cast<int>(frequency + 0.5f) << "Hz\n";
+            }
+        }
 
-        status = tobii_research_set_gaze_output_frequency(device_, 60.0f);
+        status = tobii_research_set_gaze_output_frequency(device_, frequency);
         if (status != TOBII_RESEARCH_STATUS_OK) {
-            throw TobiiDeviceError("Failed to set frequency");
+            throw TobiiDeviceError("Failed to set frequency " + std::to_string(frequency) + "Hz. Status: " + std::to_string(status));
         }
+
+        gonfig.tobii_sampling_rate = static_cast<int>(frequency + 0.5f);
+        std::cout << "[Tobii] Gaze output frequency: " << gonfig.tobii_sampling_rate << "Hz\n";
     }
     
     void _loadDisplayArea() {
@@ -201,23 +240,6 @@ private:
     }
 
     // *helper
-    TobiiResearchTimeSynchronizationData _time() {
-        auto promise = std::make_shared<std::promise<TobiiResearchTimeSynchronizationData>>();
-        auto future = promise->get_future();
-
-        auto callback = [](TobiiResearchTimeSynchronizationData* data, void* user_data) {
-            auto* p = static_cast<std::promise<TobiiResearchTimeSynchronizationData>*>(user_data);
-            p->set_value(*data);
-        };
-
-        tobii_research_subscribe_to_time_synchronization_data(device_, callback, promise.get());
-        TobiiResearchTimeSynchronizationData sync = future.get();
-
-        tobii_research_unsubscribe_from_time_synchronization_data(device_, callback);
-        
-        return sync;
-    }
-
     TobiiResearchGazeData _gaze() {
         auto promise = std::make_shared<std::promise<TobiiResearchGazeData>>();
         auto future = promise->get_future();
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// installed
+#include "tobii_research.h"
+
+// local
+#include <syncorder/io/async_writer.h>
+#include <syncorder/devices/tobii/model.h>
+#include <syncorder/io/csv_formatter.h>
+#include <syncorder/io/mapped_file.h>
+
+
+/**
+ * Binary gaze log (tobii_data.gaze)
+ *
+ *   [GazeLogHeader][GazeLogField x field_count][padding to header_size]
+ *   [GazeLogRecord x N]
+ *
+ * Fixed-size little-endian records, appended in batches. The record count is
+ * derived from the file size, so the header never has to be rewritten and a
+ * torn trailing record after a crash is simply ignored.
+ */
+
+static_assert(sizeof(void*) == 8, "gaze log assumes a 64-bit little-endian target");
+
+// same layout as the ring's compact eye, so records are filled with plain copies
+using GazeLogEye = TobiiGazeEye;
+
+struct GazeLogRecord {
+    std::uint64_t index;
+    double frame_timestamp;           // ms, as written to frame_timestamp in the csv
+    std::int64_t device_time_stamp;
+    std::int64_t system_time_stamp;
+
+    GazeLogEye left;
+    GazeLogEye right;
+};
+
+static_assert(sizeof(GazeLogEye) == 40, "GazeLogEye layout changed");
+static_assert(sizeof(GazeLogRecord) == 112, "GazeLogRecord layout changed");
+static_assert(std::is_trivially_copyable_v<GazeLogRecord>, "GazeLogRecord must be trivially copyable");
+
+
+enum class GazeLogType : std::uint8_t { U8 = 1, U64, I64, F32, F64 };
+
+struct GazeLogField {
+    char name[32];
+    std::uint16_t offset;
+    GazeLogType type;
+    std::uint8_t reserved;
+};
+
+struct GazeLogHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;      // offset of the first record
+    std::uint32_t record_size;
+    std::uint32_t field_count;
+    std::uint32_t sampling_rate;    // Hz, informational
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(GazeLogField) == 36, "GazeLogField layout changed");
+static_assert(sizeof(GazeLogHeader) == 32, "GazeLogHeader layout changed");
+
+constexpr char GAZE_LOG_MAGIC[8] = {'S', 'Y', 'N', 'G', 'A', 'Z', 'E', '\0'};
+constexpr std::uint32_t GAZE_LOG_VERSION = 1;
+
+
+/**
+ * @brief record layout, one entry per field in file order
+ */
+
+#define GAZE_LOG_EYE_FIELDS(eye) \
+    {#eye "_gaze_display_x",       offsetof(GazeLogRecord, eye.display_x),       GazeLogType::F32}, \
+    {#eye "_gaze_display_y",       offsetof(GazeLogRecord, eye.display_y),       GazeLogType::F32}, \
+    {#eye "_gaze_3d_x",            offsetof(GazeLogRecord, eye.gaze_x),          GazeLogType::F32}, \
+    {#eye "_gaze_3d_y",            offsetof(GazeLogRecord, eye.gaze_y),          GazeLogType::F32}, \
+    {#eye "_gaze_3d_z",            offsetof(GazeLogRecord, eye.gaze_z),          GazeLogType::F32}, \
+    {#eye "_gaze_origin_x",        offsetof(GazeLogRecord, eye.origin_x),        GazeLogType::F32}, \
+    {#eye "_gaze_origin_y",        offsetof(GazeLogRecord, eye.origin_y),        GazeLogType::F32}, \
+    {#eye "_gaze_origin_z",        offsetof(GazeLogRecord, eye.origin_z),        GazeLogType::F32}, \
+    {#eye "_pupil_diameter",       offsetof(GazeLogRecord, eye.pupil_diameter),  GazeLogType::F32}, \
+    {#eye "_gaze_validity",        offsetof(GazeLogRecord, eye.gaze_validity),   GazeLogType::U8},  \
+    {#eye "_gaze_origin_validity", offsetof(GazeLogRecord, eye.origin_validity), GazeLogType::U8},  \
+    {#eye "_pupil_validity",       offsetof(GazeLogRecord, eye.pupil_validity),  GazeLogType::U8}
+
+struct GazeLogFieldSpec {
+    const char* name;
+    std::size_t offset;
+    GazeLogType type;
+};
+
+inline const std::vector<GazeLogFieldSpec>& gazeLogFields() {
+    static const std::vector<GazeLogFieldSpec> fields = {
+        {"index",                    offsetof(GazeLogRecord, index),             GazeLogType::U64},
+        {"frame_timestamp",          offsetof(GazeLogRecord, frame_timestamp),   GazeLogType::F64},
+        {"frame_hardware_timestamp", offsetof(GazeLogRecord, device_time_stamp), GazeLogType::I64},
+        {"system_time_stamp",        offsetof(GazeLogRecord, system_time_stamp), GazeLogType::I64},
+        GAZE_LOG_EYE_FIELDS(left),
+        GAZE_LOG_EYE_FIELDS(right),
+    };
+    return fields;
+}
+
+#undef GAZE_LOG_EYE_FIELDS
+
+inline std::uint32_t gazeLogHeaderSize() {
+    std::size_t size = sizeof(GazeLogHeader) + gazeLogFields().size() * sizeof(GazeLogField);
+    return static_cast<std::uint32_t>((size + 63) & ~std::size_t(63)); // records start cache-line aligned
+}
+
+
+/**
+ * @brief conversions
+ */
+
+inline GazeLogRecord toGazeLogRecord(std::uint64_t index, double frame_timestamp, const TobiiBufferData& sample) {
+    GazeLogRecord out;
+    out.index = index;
+    out.frame_timestamp = frame_timestamp;
+    out.device_time_stamp = sample.device_time_stamp;
+    out.system_time_stamp = sample.system_time_stamp;
+    out.left = sample.left;
+    out.right = sample.right;
+    return out;
+}
+
+
+/**
+ * @brief csv rendering, shared by TobiiBroker and the exporter
+ */
+
+constexpr const char* GAZE_CSV_HEADER =
+    "index,"
+
+    "frame_timestamp,"
+    "frame_hardware_timestamp,"
+
+    "left_gaze_display_x,"
+    "left_gaze_display_y,"
+    "left_gaze_3d_x,"
+    "left_gaze_3d_y,"
+    "left_gaze_3d_z,"
+    "left_gaze_validity,"
+
+    "left_gaze_origin_x,"
+    "left_gaze_origin_y,"
+    "left_gaze_origin_z,"
+    "left_gaze_origin_validity,"
+
+    "left_pupil_diameter,"
+    "left_pupil_validity,"
+
+    "right_gaze_display_x,"
+    "right_gaze_display_y,"
+    "right_gaze_3d_x,"
+    "right_gaze_3d_y,"
+    "right_gaze_3d_z,"
+    "right_gaze_validity,"
+
+    "right_gaze_origin_x,"
+    "right_gaze_origin_y,"
+    "right_gaze_origin_z,"
+    "right_gaze_origin_validity,"
+
+    "right_pupil_diameter,"
+    "right_pupil_validity\n";
+
+inline void writeGazeCsvEye(CsvFormatter& out, const GazeLogEye& eye) {
+    out
+        .general(eye.display_x).sep()
+        .general(eye.display_y).sep()
+        .general(eye.gaze_x).sep()
+        .general(eye.gaze_y).sep()
+        .general(eye.gaze_z).sep()
+        .integer(eye.gaze_validity).sep()
+
+        .general(eye.origin_x).sep()
+        .general(eye.origin_y).sep()
+        .general(eye.origin_z).sep()
+        .integer(eye.origin_validity).sep()
+
+        .general(eye.pupil_diameter).sep()
+        .integer(eye.pupil_validity).sep();
+}
+
+inline void writeGazeCsvRow(CsvFormatter& out, std::uint64_t index, double frame_timestamp, const TobiiBufferData& sample) {
+    out
+        .integer(index).sep()
+
+        .fixed(frame_timestamp, 14).sep()
+        .integer(sample.device_time_stamp).sep();
+
+    writeGazeCsvEye(out, sample.left);
+    writeGazeCsvEye(out, sample.right);
+
+    out.end();
+}
+
+inline void writeGazeCsvRow(CsvFormatter& out, const GazeLogRecord& record) {
+    out
+        .integer(record.index).sep()
+
+        .fixed(record.frame_timestamp, 14).sep()
+        .integer(record.device_time_stamp).sep();
+
+    writeGazeCsvEye(out, record.left);
+    writeGazeCsvEye(out, record.right);
+
+    out.end();
+}
+
+
+/**
+ * @class GazeLogWriter
+ */
+
+class GazeLogWriter {
+private:
+    AsyncWriter file_;
+
+public:
+    bool open(const std::string& path, std::uint32_t sampling_rate, const AsyncWriterOptions& options) {
+        if (!file_.open(path, options)) return false;
+
+        const auto& fields = gazeLogFields();
+        std::vector<char> header(gazeLogHeaderSize(), 0);
+
+        GazeLogHeader head{};
+        std::memcpy(head.magic, GAZE_LOG_MAGIC, sizeof(head.magic));
+        head.version = GAZE_LOG_VERSION;
+        head.header_size = static_cast<std::uint32_t>(header.size());
+        head.record_size = sizeof(GazeLogRecord);
+        head.field_count = static_cast<std::uint32_t>(fields.size());
+        head.sampling_rate = sampling_rate;
+        std::memcpy(header.data(), &head, sizeof(head));
+
+        char* cursor = header.data() + sizeof(head);
+        for (const auto& spec : fields) {
+            GazeLogField field{};
+            std::strncpy(field.name, spec.name, sizeof(field.name) - 1);
+            field.offset = static_cast<std::uint16_t>(spec.offset);
+            field.type = spec.type;
+            std::memcpy(cursor, &field, sizeof(field));
+            cursor += sizeof(field);
+        }
+
+        file_.write(header.data(), header.size());
+        return true;
+    }
+
+    void write(const GazeLogRecord* records, std::size_t count) {
+        file_.write(reinterpret_cast<const char*>(records), count * sizeof(GazeLogRecord));
+    }
+
+    void close() { file_.close(); }
+
+    bool isOpen() const { return file_.isOpen(); }
+    const AsyncWriter& writer() const { return file_; }
+};
+
+
+/**
+ * @class GazeLogReader
+ * Zero-copy view over a memory-mapped gaze log.
+ */
+
+class GazeLogReader {
+private:
+    MappedFile file_;
+    const GazeLogHeader* header_ = nullptr;
+    const GazeLogRecord* records_ = nullptr;
+    std::size_t count_ = 0;
+    std::string error_;
+
+public:
+    bool open(const std::string& path) {
+        header_ = nullptr;
+        records_ = nullptr;
+        count_ = 0;
+
+        if (!file_.openRead(path)) return _fail("cannot map file");
+        if (file_.size() < sizeof(GazeLogHeader)) return _fail("file too small for header");
+
+        const auto* head = reinterpret_cast<const GazeLogHeader*>(file_.data());
+        if (std::memcmp(head->magic, GAZE_LOG_MAGIC, sizeof(head->magic)) != 0) return _fail("bad magic");
+        if (head->version != GAZE_LOG_VERSION) return _fail("unsupported version " + std::to_string(head->version));
+        if (head->record_size != sizeof(GazeLogRecord)) return _fail("unexpected record size " + std::to_string(head->record_size));
+        if (head->header_size > file_.size() || head->header_size % alignof(GazeLogRecord) != 0) return _fail("bad header size");
+        if (!_fieldsMatch(*head)) return _fail("field table does not match this build");
+
+        header_ = head;
+        records_ = reinterpret_cast<const GazeLogRecord*>(file_.data() + head->header_size);
+        count_ = (file_.size() - head->header_size) / sizeof(GazeLogRecord);
+        return true;
+    }
+
+    void close() {
+        file_.close();
+        header_ = nullptr;
+        records_ = nullptr;
+        count_ = 0;
+    }
+
+    const GazeLogHeader& header() const { return *header_; }
+    const GazeLogRecord* begin() const { return records_; }
+    const GazeLogRecord* end() const { return records_ + count_; }
+    const GazeLogRecord& operator[](std::size_t i) const { return records_[i]; }
+    std::size_t size() const { return count_; }
+    const std::string& error() const { return error_; }
+
+private:
+    bool _fail(const std::string& reason) {
+        error_ = reason;
+        file_.close();
+        return false;
+    }
+
+    bool _fieldsMatch(const GazeLogHeader& head) const {
+        const auto& fields = gazeLogFields();
+        if (head.field_count != fields.size()) return false;
+        if (sizeof(GazeLogHeader) + fields.size() * sizeof(GazeLogField) > head.header_size) return false;
+
+        const char* cursor = file_.data() + sizeof(GazeLogHeader);
+        for (const auto& spec : fields) {
+            GazeLogField field;
+            std::memcpy(&field, cursor, sizeof(field));
+            cursor += sizeof(field);
+
+            if (std::strncmp(field.name, spec.name, sizeof(field.name)) != 0) return false;
+            if (field.offset != spec.offset || field.type != spec.type) return false;
+        }
+        return true;
+    }
+};
@@ -14,6 +14,7 @@
 #include <syncorder/devices/tobii/broker.cpp>
 #include <syncorder/devices/tobii/checker.cpp>
 #include <syncorder/devices/tobii/verifier.cpp>
+#include <syncorder/devices/tobii/session_rate.h>
 
 
 /**
@@ -36,10 +37,6 @@ private:
     // converter
     std::unique_ptr<TSConverter> converter_;
 
-    // calibrate
-    std::thread cb_thread_;
-    std::atomic<bool> calibrate_in_progress_{true};
-
     // monitor
     std::thread mt_thread_;
     std::atomic<bool> monitor_in_progress_{false};
@@ -68,9 +65,24 @@ public:
         // callback
         callback_->setup(static_cast<void*>(buffer_.get()));
 
+        // buffer
+        buffer_->setCapacity(ringCapacity(gonfig.tobii_sampling_rate, gonfig.buffer_headroom_seconds));
+
+        OverflowOptions overflow;
+        overflow.block_timeout = std::chrono::milliseconds(gonfig.overflow_block_timeout_ms);
+        overflow.spill_path = gonfig.output_path + "tobii/overflow.spill";
+        if (!buffer_->setOverflowPolicy(parseOverflowPolicy(gonfig.tobii_overflow_policy), overflow)) {
+            std::cout << "[Tobii] Overflow policy '" << gonfig.tobii_overflow_policy << "' unavailable, using drop_newest\n";
+        }
+
         // broker
         broker_->pre_setup(converter_.get());
-        broker_->setup(buffer_.get(), reinterpret_cast<void*>(&TobiiBuffer::dequeue));
+        broker_->setup(buffer_.get());
+        broker_->setBatchInterval(gonfig.tobii_sampling_rate, std::chrono::milliseconds(gonfig.broker_batch_interval_ms));
+
+        // the rate the tracker actually runs at, for check/verify of CSV sessions; rewritten in full at stop
+        std::ofstream log(gonfig.output_path + "tobii/buffer.log");
+        if (log.is_open()) log << SAMPLING_RATE_KEY << " " << gonfig.tobii_sampling_rate << "\n";
 
         // flag
         is_setup_.store(true);
@@ -79,11 +91,11 @@ public:
     }
     
     bool warmup() override {
+        callback_->arm();
         device_->warmup();
         callback_->warmup();
 
         // ts
-        calibrate_in_progress_.store(true);
         _calibrate();
 
         // monitor
@@ -107,12 +119,13 @@ public:
     }
 
     bool stop() override {
-        broker_->stop();
+        // close the gate first, then let the broker write out the ring and the spill
         buffer_->stop();
+        broker_->stop();
+        buffer_->discardRemaining();
         device_->stop();
 
-        // calibrate
-        calibrate_in_progress_.store(false);
+        _logBuffer();
 
         // monitor
         monitor_in_progress_.store(false);
@@ -132,12 +145,12 @@ public:
         return true;
     }
 
-    bool check() override {
-        return checker_->check();
+    bool check(std::ostream& log) override {
+        return checker_->check(log);
     }
 
-    bool verify() override {
-        return verifier_->verify();
+    bool verify(TaskPool& pool, std::ostream& log) override {
+        return verifier_->verify(pool, log);
     }
 
     std::string __name__() const override {
@@ -145,18 +158,85 @@ public:
     }
 
 private:
+    void _logBuffer() {
+        std::size_t capacity = buffer_->capacity();
+        std::size_t high_watermark = buffer_->highWatermark();
+
+        const Histogram& occupancy = buffer_->occupancyHistogram();
+        const Histogram& delay = buffer_->delayHistogram();
+        const Histogram& batch_time = broker_->batchTimeHistogram();
+
+        std::cout << "[Tobii] Buffer capacity: " << capacity
+                  << " (" << gonfig.buffer_headroom_seconds << "s @ " << gonfig.tobii_sampling_rate << "Hz)"
+                  << ", high watermark: " << high_watermark
+                  << " (" << (capacity ? high_watermark * 100 / capacity : 0) << "%)\n";
+        std::cout << "[Tobii] Queueing delay (us) - p50: " << delay.quantile(0.50)
+                  << ", p99: " << delay.quantile(0.99)
+                  << ", max: " << delay.maximum()
+                  << "; batch write (us) - p50: " << batch_time.quantile(0.50)
+                  << ", p99: " << batch_time.quantile(0.99)
+                  << ", max: " << batch_time.maximum() << "\n";
+
+        const AsyncWriter& writer = broker_->writer();
+        std::cout << "[Tobii] File writer - " << writer.bytesWritten() / 1024 << " KB written"
+                  << ", write (us) p99: " << writer.writeTimeHistogram().quantile(0.99)
+                  << ", max: " << writer.writeTimeHistogram().maximum()
+                  << ", stalls: " << writer.stalls()
+                  << (writer.failed() ? ", WRITE FAILED" : "") << "\n";
+
+        ClockFit utc = converter_->utc_fit();
+        std::cout << "[Tobii] Clock sync - " << utc.points << " points"
+                  << ", skew " << utc.skewPpm() << " ppm"
+                  << ", residual " << utc.residual_us << " us\n";
+
+        OverflowStats stats = buffer_->overflowStats();
+        if (stats.any()) {
+            std::cout << "[Tobii] Buffer overflow (" << overflowPolicyName(buffer_->overflowPolicy()) << ")"
+                      << " - dropped newest: " << stats.dropped_newest
+                      << ", dropped oldest: " << stats.dropped_oldest
+                      << ", blocked: " << stats.blocked
+                      << ", spilled: " << stats.spilled
+                      << ", discarded: " << stats.discarded << "\n";
+        }
+
+        // full histograms for the session
+        std::ofstream log(gonfig.output_path + "tobii/buffer.log");
+        if (!log.is_open()) return;
+
+        log << SAMPLING_RATE_KEY << " " << gonfig.tobii_sampling_rate << "\n";
+        log << "time_to_first_frame_ms " << callback_->timeToFirstFrame() << "\n";
+        log << "capacity " << capacity << "\n";
+        log << "overflow_policy " << overflowPolicyName(buffer_->overflowPolicy()) << "\n";
+        log << "dropped_newest " << stats.dropped_newest << "\n";
+        log << "dropped_oldest " << stats.dropped_oldest << "\n";
+        log << "blocked " << stats.blocked << "\n";
+        log << "spilled " << stats.spilled << "\n";
+        log << "discarded " << stats.discarded << "\n";
+        occupancy.write(log, "occupancy");
+        delay.write(log, "queueing_delay_us");
+        broker_->batchSizeHistogram().write(log, "batch_size");
+        batch_time.write(log, "batch_write_us");
+        log << "writer_stalls " << writer.stalls() << "\n";
+        writer.writeTimeHistogram().write(log, "file_write_us");
+
+        _logClock(log, "clock_utc", converter_->utc_fit());
+        _logClock(log, "clock_device", converter_->device_fit());
+    }
+
+    void _logClock(std::ostream& log, const std::string& name, const ClockFit& fit) {
+        log << name << " points=" << fit.points
+            << " skew_ppm=" << fit.skewPpm()
+            << " residual_us=" << fit.residual_us
+            << " max_rtt_us=" << fit.rtt_us << "\n";
+    }
+
+    // persistent time-sync subscription feeding the converter's clock fits
     void _calibrate() {
-        cb_thread_ = std::thread([this]() {
-            while (calibrate_in_progress_.load()) {
-                auto time = device_->getTime();
-                converter_->update_calibration(
-                    time.system_request_time_stamp,
-                    time.device_time_stamp,
-                    time.system_response_time_stamp
-                );
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
-        });
+        device_->subscribeTimeSync(&TSConverter::onTimeSync, converter_.get());
+
+        if (!converter_->wait_ready(std::chrono::milliseconds(2000))) {
+            std::cout << "[Tobii] Warning: no time sync sample yet, timestamps stay on the Tobii system clock until one arrives\n";
+        }
     }
 
     void _monitor() {
@@ -1,16 +1,81 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <type_traits>
 #include "tobii_research.h"
 #include "tobii_research_calibration.h"
 #include "tobii_research_eyetracker.h"
 #include "tobii_research_streams.h"
 
 
+/**
+ * @struct TobiiGazeEye
+ * The per-eye fields we persist, as floats plus one byte per validity.
+ * Same layout as one eye of a gaze log record.
+ */
+
+struct TobiiGazeEye {
+    float display_x;
+    float display_y;
+    float gaze_x;
+    float gaze_y;
+    float gaze_z;
+    float origin_x;
+    float origin_y;
+    float origin_z;
+    float pupil_diameter;
+
+    std::uint8_t gaze_validity;
+    std::uint8_t origin_validity;
+    std::uint8_t pupil_validity;
+    std::uint8_t reserved;
+};
+
+
 /**
  * @struct TobiiBufferData - Global Tobii Data Structure
+ * Compact gaze sample: only what is written to disk, 96 bytes instead of a
+ * full TobiiResearchGazeData (track box coordinates and enum-sized
+ * validities are dropped in the callback).
  */
 
 struct TobiiBufferData {
-    TobiiResearchGazeData gazed;
-};
\ No newline at end of file
+    std::int64_t device_time_stamp;
+    std::int64_t system_time_stamp;
+
+    TobiiGazeEye left;
+    TobiiGazeEye right;
+};
+
+static_assert(sizeof(TobiiGazeEye) == 40, "TobiiGazeEye layout changed");
+static_assert(sizeof(TobiiBufferData) == 96, "TobiiBufferData layout changed");
+static_assert(std::is_trivially_copyable_v<TobiiBufferData>, "TobiiBufferData must stay spillable");
+
+
+inline TobiiGazeEye toTobiiGazeEye(const TobiiResearchEyeData& eye) {
+    TobiiGazeEye out;
+    out.display_x = eye.gaze_point.position_on_display_area.x;
+    out.display_y = eye.gaze_point.position_on_display_area.y;
+    out.gaze_x = eye.gaze_point.position_in_user_coordinates.x;
+    out.gaze_y = eye.gaze_point.position_in_user_coordinates.y;
+    out.gaze_z = eye.gaze_point.position_in_user_coordinates.z;
+    out.origin_x = eye.gaze_origin.position_in_user_coordinates.x;
+    out.origin_y = eye.gaze_origin.position_in_user_coordinates.y;
+    out.origin_z = eye.gaze_origin.position_in_user_coordinates.z;
+    out.pupil_diameter = eye.pupil_data.diameter;
+    out.gaze_validity = static_cast<std::uint8_t>(eye.gaze_point.validity);
+    out.origin_validity = static_cast<std::uint8_t>(eye.gaze_origin.validity);
+    out.pupil_validity = static_cast<std::uint8_t>(eye.pupil_data.validity);
+    out.reserved = 0;
+    return out;
+}
+
+inline TobiiBufferData toTobiiBufferData(const TobiiResearchGazeData& gazed) {
+    TobiiBufferData out;
+    out.device_time_stamp = gazed.device_time_stamp;
+    out.system_time_stamp = gazed.system_time_stamp;
+    out.left = toTobiiGazeEye(gazed.left_eye);
+    out.right = toTobiiGazeEye(gazed.right_eye);
+    return out;
+}
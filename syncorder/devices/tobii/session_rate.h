@@ -0,0 +1,36 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+
+/**
+ * The gaze rate a session was recorded at.
+ *
+ * The tracker may not support the requested --tobii_sampling_rate, in
+ * which case the recorder runs at the nearest rate it does support. Only
+ * the recorder knows that rate, so TobiiManager writes it to the session's
+ * tobii/buffer.log as "sampling_rate_hz <n>", and check/verify read it back
+ * for CSV sessions. A .gaze log carries its rate in its own header.
+ */
+
+constexpr const char* SAMPLING_RATE_KEY = "sampling_rate_hz";
+
+// rate from <tobii_dir>/buffer.log; 0 if the session has none (older recordings, or no clean stop)
+inline int recordedSamplingRate(const std::string& tobii_dir) {
+    std::ifstream log(tobii_dir + "/buffer.log");
+    const std::string prefix = std::string(SAMPLING_RATE_KEY) + " ";
+
+    std::string line;
+    while (std::getline(log, line)) {
+        if (line.rfind(prefix, 0) != 0) continue;
+
+        try {
+            int rate = std::stoi(line.substr(prefix.size()));
+            return rate > 0 ? rate : 0;
+        } catch (...) {
+            return 0;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <thread>
+
+// installed
+#include "tobii_research.h"
+#include "tobii_research_streams.h"
+
+
+/**
+ * @class SyntheticGazeSource
+ * Stand-in for the eye tracker's gaze subscription, for exercising the
+ * callback -> buffer -> broker -> writer chain without hardware.
+ *
+ * A thread calls the gaze callback at rate_hz with plausible samples: a
+ * slowly circling gaze point, valid eyes, and system/device timestamps
+ * that advance by exactly one period. The schedule is absolute, so a late
+ * wakeup is caught up with a burst, as the tracker's USB delivery does.
+ */
+
+class SyntheticGazeSource {
+private:
+    tobii_research_gaze_data_callback callback_ = nullptr;
+    void* user_data_ = nullptr;
+    double rate_hz_ = 0.0;
+
+    std::atomic<bool> running_{false};
+    std::atomic<std::uint64_t> sent_{0};
+    std::thread thread_;
+
+public:
+    SyntheticGazeSource() = default;
+    ~SyntheticGazeSource() { stop(); }
+
+    SyntheticGazeSource(const SyntheticGazeSource&) = delete;
+    SyntheticGazeSource& operator=(const SyntheticGazeSource&) = delete;
+
+public:
+    void start(double rate_hz, tobii_research_gaze_data_callback callback, void* user_data) {
+        stop();
+
+        rate_hz_ = rate_hz;
+        callback_ = callback;
+        user_data_ = user_data;
+        sent_.store(0);
+
+        running_.store(true);
+        thread_ = std::thread(&SyntheticGazeSource::_run, this);
+    }
+
+    void stop() {
+        running_.store(false);
+        if (thread_.joinable()) thread_.join();
+    }
+
+    // samples delivered to the callback so far
+    std::uint64_t sent() const {
+        return sent_.load(std::memory_order_acquire);
+    }
+
+private:
+    void _run() {
+        using clock = std::chrono::steady_clock;
+        const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / rate_hz_));
+        const auto start = clock::now();
+        const std::int64_t system_start = std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()).count();
+
+        TobiiResearchGazeData gaze{};
+        std::uint64_t n = 0;
+
+        while (running_.load(std::memory_order_relaxed)) {
+            // everything due by now, then sleep to the next tick
+            auto now = clock::now();
+            while (start + period * static_cast<std::int64_t>(n) <= now) {
+                _fill(gaze, n, system_start + static_cast<std::int64_t>(n * 1e6 / rate_hz_));
+                callback_(&gaze, user_data_);
+                sent_.store(++n, std::memory_order_release);
+            }
+
+            std::this_thread::sleep_until(start + period * static_cast<std::int64_t>(n));
+        }
+    }
+
+    static void _fill(TobiiResearchGazeData& gaze, std::uint64_t n, std::int64_t system_us) {
+        // one circle every 4 s around the middle of the display
+        double angle = static_cast<double>(system_us % 4000000) / 4000000.0 * 6.283185307179586;
+        float x = static_cast<float>(0.5 + 0.2 * std::cos(angle));
+        float y = static_cast<float>(0.5 + 0.2 * std::sin(angle));
+
+        for (TobiiResearchEyeData* eye : {&gaze.left_eye, &gaze.right_eye}) {
+            float side = (eye == &gaze.left_eye) ? -1.0f : 1.0f;
+
+            eye->gaze_point.position_on_display_area = {x, y};
+            eye->gaze_point.position_in_user_coordinates = {(x - 0.5f) * 500.0f, (0.5f - y) * 300.0f, 0.0f};
+            eye->gaze_point.validity = TOBII_RESEARCH_VALIDITY_VALID;
+
+            eye->gaze_origin.position_in_user_coordinates = {side * 32.0f, 0.0f, 600.0f};
+            eye->gaze_origin.validity = TOBII_RESEARCH_VALIDITY_VALID;
+
+            eye->pupil_data.diameter = 3.5f + 0.1f * static_cast<float>(n % 10);
+            eye->pupil_data.validity = TOBII_RESEARCH_VALIDITY_VALID;
+        }
+
+        gaze.system_time_stamp = system_us;
+        gaze.device_time_stamp = system_us + 1000000;
+    }
+};
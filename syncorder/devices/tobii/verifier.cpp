@@ -10,6 +10,9 @@
 // local
 #include <syncorder/gonfig/gonfig.h>
 #include <syncorder/devices/common/verifier_base.h>
+#include <syncorder/io/csv_scanner.h>
+#include <syncorder/devices/tobii/gaze_log.cpp>
+#include <syncorder/devices/tobii/session_rate.h>
 
 
 /**
@@ -44,22 +47,26 @@ public:
     ~TobiiVerifier() = default;
 
 public:
-    bool verify() override {
-        std::cout << "[Tobii] Starting verification\n";
+    bool verify(TaskPool& pool, std::ostream& log) override {
+        pool_ = &pool;
+        log_ = &log;
+        _log() << "[Tobii] Starting verification\n";
 
         result_ = true;
         video_results_.clear();
+        cache_.load(gonfig.verified_path + "tobii_verify_cache.log", gonfig.verify_rebuild);
 
-        // Collect all sessions with their timing data and CSV paths
+        // Collect all sessions with their timing data and data file (gaze log or CSV)
         struct SessionData {
             std::string session_name;
             std::string session_path;
             FrameTimingData timing;
-            std::string csv_path;
+            std::string data_path;
         };
         std::vector<SessionData> sessions;
 
         // Scan for session directories
+        std::vector<SessionData> candidates;
         for (const auto& entry : std::filesystem::directory_iterator(output_path_)) {
             if (!entry.is_directory()) continue;
 
@@ -69,31 +76,47 @@ public:
             SessionData session;
             session.session_name = dir_name;
             session.session_path = entry.path().generic_string();
+            candidates.push_back(session);
+        }
+
+        _runEach(candidates.size(), [&](std::size_t i, std::ostream& task_log) {
+            SessionData& session = candidates[i];
 
             // Parse frame_timing.log from this session
             std::string timing_path = session.session_path + "/frame_timing.log";
-            session.timing = _parseFrameTiming(timing_path);
+            session.timing = _parseFrameTiming(timing_path, task_log);
 
-            // Find Tobii CSV file in this session
+            // Find Tobii data file in this session, binary gaze log preferred over CSV
             std::string tobii_path = session.session_path + "/tobii";
             if (std::filesystem::exists(tobii_path)) {
+                std::string csv_path;
                 for (const auto& file : std::filesystem::directory_iterator(tobii_path)) {
-                    if (file.is_regular_file() && file.path().extension().string() == ".csv") {
-                        session.csv_path = file.path().generic_string();
+                    if (!file.is_regular_file()) continue;
+
+                    auto ext = file.path().extension().string();
+                    if (ext == ".gaze") {
+                        session.data_path = file.path().generic_string();
                         break;
                     }
+                    if (ext == ".csv" && csv_path.empty()) {
+                        csv_path = file.path().generic_string();
+                    }
                 }
+                if (session.data_path.empty()) session.data_path = csv_path;
             }
 
-            if (session.timing.valid && !session.csv_path.empty()) {
-                sessions.push_back(session);
-                std::cout << "[Tobii] Found session: " << dir_name << " with "
-                          << session.timing.videos.size() << " video(s)\n";
+            if (session.timing.valid && !session.data_path.empty()) {
+                task_log << "[Tobii] Found session: " << session.session_name << " with "
+                         << session.timing.videos.size() << " video(s)\n";
             }
+        });
+
+        for (auto& session : candidates) {
+            if (session.timing.valid && !session.data_path.empty()) sessions.push_back(std::move(session));
         }
 
         if (sessions.empty()) {
-            std::cout << "[Tobii] Error: No valid sessions found\n";
+            _log() << "[Tobii] Error: No valid sessions found\n";
             result_ = false;
             return result_;
         }
@@ -112,22 +135,26 @@ public:
                 // Always update with the later session (overwrites previous)
                 VideoSessionInfo info;
                 info.video = video;
-                info.csv_path = session.csv_path;
+                info.data_path = session.data_path;
                 latest_videos[video.video_index] = info;
-                std::cout << "[Tobii] Video " << video.video_index
-                          << " from session " << session.session_name << "\n";
+                _log() << "[Tobii] Video " << video.video_index
+                       << " from session " << session.session_name << "\n";
             }
         }
 
-        std::cout << "[Tobii] Using " << latest_videos.size()
-                  << " video(s) from latest recordings\n";
+        _log() << "[Tobii] Using " << latest_videos.size()
+               << " video(s) from latest recordings\n";
 
         // Verify each video with its corresponding CSV file
         result_ = _verifyCsvsByVideoIndividually(latest_videos);
 
         _writeResult();
 
-        std::cout << "[Tobii] Verify phase " << (result_ ? "completed" : "failed") << "\n";
+        if (!cache_.save()) {
+            _log() << "[Tobii] Failed to write verification cache\n";
+        }
+
+        _log() << "[Tobii] Verify phase " << (result_ ? "completed" : "failed") << "\n";
 
         return result_;
     }
@@ -135,43 +162,101 @@ public:
 private:
     struct VideoSessionInfo {
         VideoTimingData video;
-        std::string csv_path;
+        std::string data_path;
+    };
+
+    // one data file, read once for all the videos it covers
+    struct DataIndex {
+        SampleTimeline timeline;  // flagged: both eyes lost
+        int sampling_rate{0};     // from the gaze log header, 0 for CSV (see recordedSamplingRate)
     };
 
     bool _verifyCsvsByVideoIndividually(const std::map<int, VideoSessionInfo>& video_sessions) {
         bool all_valid = true;
 
+        // every data file is indexed once, all of them in parallel, unless the cache has it
+        std::vector<CachedFile> files;
+        std::map<std::string, std::size_t> path_slot;
+        for (const auto& [video_index, info] : video_sessions) {
+            auto inserted = path_slot.emplace(info.data_path, files.size());
+            if (inserted.second) {
+                files.emplace_back();
+                files.back().path = info.data_path;
+            }
+            files[inserted.first->second].windows.push_back({info.video.start_time, info.video.end_time});
+        }
+
+        _reuseOrRead(files, [this](CachedFile& file, std::ostream& task_log) {
+            bool binary = std::filesystem::path(file.path).extension() == ".gaze";
+
+            DataIndex index;
+            bool loaded = binary
+                ? _loadGazeLogIndex(file.path, index, task_log)
+                : _loadCsvIndex(file.path, index, task_log);
+            if (!loaded) return;
+
+            file.entry.value = index.sampling_rate;  // the rate a gaze log was recorded at
+            for (const auto& range : file.windows) {
+                file.entry.windows[range] = index.timeline.window(range.first, range.second);
+            }
+            file.ready = true;
+        });
+
+        // a gaze log knows its rate; for a CSV the recorder wrote it to the session's buffer.log
+        std::vector<int> file_rate(files.size(), 0);
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            file_rate[i] = files[i].entry.value
+                ? files[i].entry.value
+                : recordedSamplingRate(std::filesystem::path(files[i].path).parent_path().generic_string());
+        }
+
         for (const auto& [video_index, info] : video_sessions) {
             TobiiVideoResult result;
             result.video_name = info.video.getVideoName();
             result.duration = info.video.getDuration();
-            result.expected_frames = (int)(result.duration * 60); // 60fps
+            result.expected_frames = (int)(result.duration * gonfig.tobii_sampling_rate);
 
-            std::cout << "\n[Tobii] Processing " << result.video_name
-                      << " from CSV: " << info.csv_path << "\n";
+            bool binary = std::filesystem::path(info.data_path).extension() == ".gaze";
 
-            // Process CSV file for this specific video
-            if (!_processCsvFileForVideo(info.csv_path, info.video, result)) {
-                std::cout << "[Tobii] Failed to process CSV for " << result.video_name << "\n";
+            _log() << "\n[Tobii] Processing " << result.video_name
+                   << (binary ? " from gaze log: " : " from CSV: ") << info.data_path << "\n";
+
+            std::size_t slot = path_slot[info.data_path];
+            const CachedFile& file = files[slot];
+            if (!file.ready) {
+                _log() << "[Tobii] Failed to process data file for " << result.video_name << "\n";
                 result.valid = false;
                 all_valid = false;
             } else {
-                std::cout << "  Duration: " << result.duration << "s\n";
-                std::cout << "  Total frames: " << result.total_frames << "\n";
-                std::cout << "  Expected frames: " << result.expected_frames << "\n";
-                std::cout << "  Tracking success: " << result.tracking_success_frames << "\n";
-                std::cout << "  Tracking failed: " << result.tracking_failed_frames << "\n";
+                // recorded rate when the session has one, else --tobii_sampling_rate
+                if (file_rate[slot]) {
+                    result.expected_frames = (int)(result.duration * file_rate[slot]);
+                }
+
+                SampleTimeline::Window window;
+                file.entry.findWindow(info.video.start_time, info.video.end_time, window);
+                result.total_frames = window.total;
+                result.tracking_failed_frames = window.flagged;
+                result.tracking_success_frames = window.total - window.flagged;
+
+                _log() << "  Sampling rate: " << (file_rate[slot] ? file_rate[slot] : gonfig.tobii_sampling_rate) << "Hz"
+                       << (file_rate[slot] ? "\n" : " (--tobii_sampling_rate)\n");
+                _log() << "  Duration: " << result.duration << "s\n";
+                _log() << "  Total frames: " << result.total_frames << "\n";
+                _log() << "  Expected frames: " << result.expected_frames << "\n";
+                _log() << "  Tracking success: " << result.tracking_success_frames << "\n";
+                _log() << "  Tracking failed: " << result.tracking_failed_frames << "\n";
 
                 // Validation: check if total rows match expected frames (with tolerance)
                 if (result.total_frames < result.expected_frames * 0.95) {
-                    std::cout << "  Status: FAILED (insufficient frames)\n";
+                    _log() << "  Status: FAILED (insufficient frames)\n";
                     result.valid = false;
                     all_valid = false;
                 } else if (result.total_frames > result.expected_frames * 1.1) {
-                    std::cout << "  Status: WARNING (too many frames)\n";
+                    _log() << "  Status: WARNING (too many frames)\n";
                     result.valid = true; // Still valid but with warning
                 } else {
-                    std::cout << "  Status: PASSED\n";
+                    _log() << "  Status: PASSED\n";
                     result.valid = true;
                 }
             }
@@ -182,194 +267,78 @@ private:
         return all_valid;
     }
 
-    bool _processCsvFileForVideo(const std::string& csv_path, const VideoTimingData& video,
-                                  TobiiVideoResult& result) {
+    bool _loadCsvIndex(const std::string& csv_path, DataIndex& index, std::ostream& log) {
         if (!std::filesystem::exists(csv_path)) {
-            std::cout << "[Tobii] CSV file does not exist: " << csv_path << "\n";
+            log << "[Tobii] CSV file does not exist: " << csv_path << "\n";
             return false;
         }
 
         try {
-            std::ifstream file(csv_path);
-            std::string line;
-
-            // Read and verify header
-            if (!std::getline(file, line)) {
-                std::cout << "[Tobii] Could not read header\n";
+            CsvScanner scanner;
+            if (!scanner.open(csv_path)) {
+                log << "[Tobii] Could not open CSV file: " << csv_path << "\n";
                 return false;
             }
 
-            if (line.find("index,") != 0) {
-                std::cout << "[Tobii] Invalid CSV header format\n";
+            // Read and verify header
+            if (scanner.header().find("index,") != 0) {
+                log << "[Tobii] Invalid CSV header format\n";
                 return false;
             }
 
-            // Parse CSV rows for this specific video based on timestamp
-            while (std::getline(file, line)) {
-                if (line.empty()) continue;
+            // CSV columns: frame_timestamp (index 1), left_gaze_validity (index 8), right_gaze_validity (index 19)
+            scanner.select({1, 8, 19});
+            index.timeline.times.reserve(scanner.fileSize() / 256);
+            index.timeline.flags.reserve(scanner.fileSize() / 256);
 
-                // Parse CSV row (index,timestamp,hw_ts,left_x,left_y,...,left_validity,...,right_x,right_y,...,right_validity,...)
-                std::istringstream iss(line);
-                std::vector<std::string> fields;
-                std::string field;
-                while (std::getline(iss, field, ',')) {
-                    fields.push_back(field);
-                }
-
-                if (fields.size() < 20) continue; // Need at least validity fields
+            while (scanner.next()) {
+                if (!scanner.complete()) continue; // Need at least validity fields
 
                 double frame_timestamp = 0.0;
-                try {
-                    frame_timestamp = std::stod(fields[1]); // frame_timestamp column
-                } catch (...) {
+                if (!CsvScanner::parse(scanner.field(0), frame_timestamp)) {
                     continue; // Skip invalid rows
                 }
 
+                // Check tracking quality: both eyes must be invalid for tracking_failed
+                bool left_valid = (scanner.field(1) == "1");
+                bool right_valid = (scanner.field(2) == "1");
+
                 // Convert timestamp from milliseconds to seconds
-                double frame_time_sec = frame_timestamp / 1000.0;
-
-                // Check if this frame belongs to this specific video
-                if (frame_time_sec >= video.start_time && frame_time_sec <= video.end_time) {
-                    result.total_frames++;
-
-                    // Check tracking quality: both eyes must be invalid for tracking_failed
-                    // CSV columns: left_gaze_validity (index 8), right_gaze_validity (index 19)
-                    bool left_valid = (fields.size() > 8 && fields[8] == "1");
-                    bool right_valid = (fields.size() > 19 && fields[19] == "1");
-
-                    if (!left_valid && !right_valid) {
-                        // Both eyes failed tracking
-                        result.tracking_failed_frames++;
-                    } else {
-                        // At least one eye tracked successfully
-                        result.tracking_success_frames++;
-                    }
-                }
+                index.timeline.add(frame_timestamp / 1000.0, !left_valid && !right_valid);
             }
 
+            index.timeline.finish();
+            log << "[Tobii] Indexed " << index.timeline.size() << " samples from " << csv_path << "\n";
             return true;
 
         } catch (const std::exception& e) {
-            std::cout << "[Tobii] CSV processing failed: " << e.what() << "\n";
+            log << "[Tobii] CSV processing failed: " << e.what() << "\n";
             return false;
         }
     }
 
-    bool _verifyCsvsByVideo(const std::vector<std::string>& csv_paths, const FrameTimingData& timing) {
-        // Initialize result for each video
-        std::map<int, TobiiVideoResult> video_results_map;
-        for (const auto& video : timing.videos) {
-            TobiiVideoResult result;
-            result.video_name = video.getVideoName();
-            result.duration = video.getDuration();
-            result.expected_frames = (int)(result.duration * 60); // 60fps
-            video_results_map[video.video_index] = result;
-        }
-
-        // Process all CSV files
-        for (const auto& csv_path : csv_paths) {
-            if (!_processCsvFile(csv_path, timing, video_results_map)) {
-                return false;
-            }
-        }
-
-        // Validate each video and store results
-        bool all_valid = true;
-        for (auto& [video_index, result] : video_results_map) {
-            std::cout << "\n[Tobii] " << result.video_name << ":\n";
-            std::cout << "  Duration: " << result.duration << "s\n";
-            std::cout << "  Total frames: " << result.total_frames << "\n";
-            std::cout << "  Expected frames: " << result.expected_frames << "\n";
-            std::cout << "  Tracking success: " << result.tracking_success_frames << "\n";
-            std::cout << "  Tracking failed: " << result.tracking_failed_frames << "\n";
-
-            // Validation: check if total rows match expected frames (with tolerance)
-            if (result.total_frames < result.expected_frames * 0.95) {
-                std::cout << "  Status: FAILED (insufficient frames)\n";
-                result.valid = false;
-                all_valid = false;
-            } else if (result.total_frames > result.expected_frames * 1.1) {
-                std::cout << "  Status: WARNING (too many frames)\n";
-                result.valid = true; // Still valid but with warning
-            } else {
-                std::cout << "  Status: PASSED\n";
-                result.valid = true;
-            }
-
-            video_results_.push_back(result);
-        }
-
-        return all_valid;
-    }
-
-    bool _processCsvFile(const std::string& csv_path, const FrameTimingData& timing,
-                         std::map<int, TobiiVideoResult>& video_results_map) {
-        std::cout << "[Tobii] Processing CSV file: " << csv_path << "\n";
-
-        if (!std::filesystem::exists(csv_path)) {
-            std::cout << "[Tobii] File does not exist\n";
+    bool _loadGazeLogIndex(const std::string& gaze_path, DataIndex& index, std::ostream& log) {
+        GazeLogReader reader;
+        if (!reader.open(gaze_path)) {
+            log << "[Tobii] Invalid gaze log " << gaze_path << ": " << reader.error() << "\n";
             return false;
         }
 
-        try {
-            std::ifstream file(csv_path);
-            std::string line;
-
-            // Read and verify header
-            if (!std::getline(file, line)) {
-                std::cout << "[Tobii] Could not read header\n";
-                return false;
-            }
-
-            if (line.find("index,") != 0) {
-                std::cout << "[Tobii] Invalid CSV header format\n";
-                return false;
-            }
+        index.sampling_rate = reader.header().sampling_rate;
+        index.timeline.times.reserve(reader.size());
+        index.timeline.flags.reserve(reader.size());
 
-            // Parse CSV rows and assign to videos based on timestamp
-            while (std::getline(file, line)) {
-                if (line.empty()) continue;
+        // same rules as the CSV path, read in place from the mapped records
+        for (const GazeLogRecord& record : reader) {
+            bool left_valid = (record.left.gaze_validity == TOBII_RESEARCH_VALIDITY_VALID);
+            bool right_valid = (record.right.gaze_validity == TOBII_RESEARCH_VALIDITY_VALID);
 
-                // Parse timestamp from CSV (format: index,frame_timestamp,...)
-                std::istringstream iss(line);
-                std::string index_str, timestamp_str;
-                std::getline(iss, index_str, ',');
-                std::getline(iss, timestamp_str, ',');
-
-                double frame_timestamp = 0.0;
-                try {
-                    frame_timestamp = std::stod(timestamp_str);
-                } catch (...) {
-                    continue; // Skip invalid rows
-                }
-
-                // Convert timestamp from milliseconds to seconds
-                double frame_time_sec = frame_timestamp / 1000.0;
-
-                // Find which video this frame belongs to
-                for (const auto& video : timing.videos) {
-                    if (frame_time_sec >= video.start_time && frame_time_sec <= video.end_time) {
-                        auto& result = video_results_map[video.video_index];
-                        result.total_frames++;
-
-                        // Check tracking quality
-                        if (line.find("-nan(ind)") != std::string::npos) {
-                            result.tracking_failed_frames++;
-                        } else {
-                            result.tracking_success_frames++;
-                        }
-
-                        break;
-                    }
-                }
-            }
-
-            return true;
-
-        } catch (const std::exception& e) {
-            std::cout << "[Tobii] CSV processing failed: " << e.what() << "\n";
-            return false;
+            index.timeline.add(record.frame_timestamp / 1000.0, !left_valid && !right_valid);
         }
+
+        index.timeline.finish();
+        log << "[Tobii] Indexed " << index.timeline.size() << " samples from " << gaze_path << "\n";
+        return true;
     }
 
     void _writeResult() {
@@ -381,7 +350,7 @@ private:
         std::ofstream csv(csv_path);
 
         if (!csv.is_open()) {
-            std::cout << "[Tobii] Failed to create result CSV file: " << csv_path << "\n";
+            _log() << "[Tobii] Failed to create result CSV file: " << csv_path << "\n";
             return;
         }
 
@@ -399,6 +368,6 @@ private:
         }
 
         csv.close();
-        std::cout << "[Tobii] Results written to " << csv_path << "\n";
+        _log() << "[Tobii] Results written to " << csv_path << "\n";
     }
 };
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+
+// local
+#include <syncorder/io/csv_formatter.h>
+#include <syncorder/devices/tobii/gaze_log.cpp>
+
+
+/**
+ * @main
+ * Converts a binary gaze log (tobii_data.gaze) into the same CSV the
+ * recorder writes in csv mode.
+ *
+ *   exporter.exe <tobii_data.gaze> [output.csv]
+ */
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <tobii_data.gaze> [output.csv]\n";
+        return 1;
+    }
+
+    std::string gaze_path = argv[1];
+    std::string csv_path = (argc > 2)
+        ? std::string(argv[2])
+        : std::filesystem::path(gaze_path).replace_extension(".csv").generic_string();
+
+    GazeLogReader reader;
+    if (!reader.open(gaze_path)) {
+        std::cout << "[ERROR] Cannot read " << gaze_path << ": " << reader.error() << "\n";
+        return 1;
+    }
+
+    std::ofstream csv(csv_path, std::ios::binary | std::ios::trunc);
+    if (!csv.is_open()) {
+        std::cout << "[ERROR] Cannot create " << csv_path << "\n";
+        return 1;
+    }
+
+    csv << GAZE_CSV_HEADER;
+
+    CsvFormatter rows(1 << 20);
+    for (const GazeLogRecord& record : reader) {
+        writeGazeCsvRow(rows, record);
+        if (rows.size() >= (1 << 20) - 1024) rows.flush(csv);
+    }
+    rows.flush(csv);
+    csv.close();
+
+    std::cout << "[INFO] Exported " << reader.size() << " records to " << csv_path << "\n";
+    return 0;
+}
@@ -28,6 +28,66 @@ Config Config::parseArgs(int argc, char* argv[]) {
         else if (arg == "--record_duration" && i + 1 < argc) {
             conf.record_duration = std::stoi(argv[++i]);
         }
+        else if (arg == "--tobii_sampling_rate" && i + 1 < argc) {
+            conf.tobii_sampling_rate = std::stoi(argv[++i]);
+        }
+        else if (arg == "--realsense_frame_rate" && i + 1 < argc) {
+            conf.realsense_frame_rate = std::stoi(argv[++i]);
+        }
+        else if (arg == "--tobii_output_format" && i + 1 < argc) {
+            conf.tobii_output_format = argv[++i];
+        }
+        else if (arg == "--tobii_timestamp_source" && i + 1 < argc) {
+            conf.tobii_timestamp_source = argv[++i];
+        }
+        else if (arg == "--buffer_headroom_seconds" && i + 1 < argc) {
+            conf.buffer_headroom_seconds = std::stod(argv[++i]);
+        }
+        else if (arg == "--tobii_overflow_policy" && i + 1 < argc) {
+            conf.tobii_overflow_policy = argv[++i];
+        }
+        else if (arg == "--realsense_overflow_policy" && i + 1 < argc) {
+            conf.realsense_overflow_policy = argv[++i];
+        }
+        else if (arg == "--overflow_block_timeout_ms" && i + 1 < argc) {
+            conf.overflow_block_timeout_ms = std::stoi(argv[++i]);
+        }
+        else if (arg == "--realsense_frame_pool" && i + 1 < argc) {
+            conf.realsense_frame_pool = std::stoi(argv[++i]);
+        }
+        else if (arg == "--broker_batch_interval_ms" && i + 1 < argc) {
+            conf.broker_batch_interval_ms = std::stoi(argv[++i]);
+        }
+        else if (arg == "--writer_buffer_kb" && i + 1 < argc) {
+            conf.writer_buffer_kb = std::stoi(argv[++i]);
+        }
+        else if (arg == "--writer_buffer_count" && i + 1 < argc) {
+            conf.writer_buffer_count = std::stoi(argv[++i]);
+        }
+        else if (arg == "--writer_flush_interval_ms" && i + 1 < argc) {
+            conf.writer_flush_interval_ms = std::stoi(argv[++i]);
+        }
+        else if (arg == "--preview_rate_hz" && i + 1 < argc) {
+            conf.preview_rate_hz = std::stoi(argv[++i]);
+        }
+        else if (arg == "--preview_max_width" && i + 1 < argc) {
+            conf.preview_max_width = std::stoi(argv[++i]);
+        }
+        else if (arg == "--preview_shm_name" && i + 1 < argc) {
+            conf.preview_shm_name = argv[++i];
+        }
+        else if (arg == "--preview_png" && i + 1 < argc) {
+            conf.preview_png = std::stoi(argv[++i]) != 0;
+        }
+        else if (arg == "--verify_threads" && i + 1 < argc) {
+            conf.verify_threads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--verify_rebuild" && i + 1 < argc) {
+            conf.verify_rebuild = std::stoi(argv[++i]) != 0;
+        }
+        else if (arg == "--verify_deep" && i + 1 < argc) {
+            conf.verify_deep = std::stoi(argv[++i]) != 0;
+        }
     }
 
     return conf;
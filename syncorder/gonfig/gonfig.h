@@ -16,6 +16,51 @@ public:
 
     int record_duration = 5;
     int tobii_sampling_rate = 120;  // Tobii eye tracker sampling rate (Hz)
+    int realsense_frame_rate = 60;  // RealSense color/depth frame rate (fps)
+
+    // tobii output: csv (tobii_data.csv) | binary (tobii_data.gaze, see exporter for csv)
+    std::string tobii_output_format = "csv";
+
+    // tobii frame_timestamp source: system (host receive time) | device (eye tracker clock
+    // through the fitted drift model, free of host receive jitter); both raw stamps are kept
+    std::string tobii_timestamp_source = "system";
+
+    // ring buffers hold this many seconds of samples at the stream rate
+    double buffer_headroom_seconds = 16.0;
+
+    // buffer overflow policy: drop_newest | drop_oldest | block | spill
+    std::string tobii_overflow_policy = "spill";            // nothing lost unless the spill file fills; drained at stop
+    std::string realsense_overflow_policy = "drop_oldest";  // bounded latency
+    int overflow_block_timeout_ms = 5;
+
+    // realsense frame pool: copy framesets into this many preallocated slots so the
+    // SDK frames are released at once; 0 keeps the SDK frames until written
+    int realsense_frame_pool = 0;
+
+    // brokers wait up to this long between batches (fewer wakeups at high rates), 0 writes on arrival
+    int broker_batch_interval_ms = 10;
+
+    // async file writers: in-flight memory is writer_buffer_kb * writer_buffer_count per file
+    int writer_buffer_kb = 1024;
+    int writer_buffer_count = 4;
+    int writer_flush_interval_ms = 200;
+
+    // realsense live preview: color + false-colored depth on shared memory, 0 rate disables
+    int preview_rate_hz = 10;
+    int preview_max_width = 320;                         // pixels, 0 keeps full resolution
+    std::string preview_shm_name = "SyncorderPreview";   // empty disables the shared memory channel
+    bool preview_png = false;                            // also write realsense/monitor.png (1s)
+
+    // check/verify task pool threads (devices, sessions, files), 0 uses every core, 1 runs serially
+    int verify_threads = 0;
+
+    // verify reuses per-file results from <verified_path>/*_verify_cache.log while a file's
+    // size, mtime and sampled hash are unchanged; 1 ignores the cache and rebuilds it
+    bool verify_rebuild = false;
+
+    // check/verify trust a bag whose <bag>.complete marker matches its size; 1 also opens
+    // every bag with the SDK (bags without a marker are always opened)
+    bool verify_deep = false;
 
     static Config parseArgs(int argc, char* argv[]);
 };
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+// local
+#include <syncorder/gonfig/gonfig.h>
+#include <syncorder/io/async_writer.h>
+
+
+// data file writers: --writer_buffer_kb, --writer_buffer_count, --writer_flush_interval_ms
+inline AsyncWriterOptions configuredWriterOptions() {
+    AsyncWriterOptions options;
+    options.buffer_size = static_cast<std::size_t>((std::max)(gonfig.writer_buffer_kb, 4)) * 1024;
+    options.buffer_count = static_cast<std::size_t>((std::max)(gonfig.writer_buffer_count, 2));
+    options.flush_interval = std::chrono::milliseconds((std::max)(gonfig.writer_flush_interval_ms, 1));
+    return options;
+}
+
+// low-rate text logs (monitors): small buffers, same flush interval
+inline AsyncWriterOptions logWriterOptions() {
+    AsyncWriterOptions options;
+    options.buffer_size = 16 * 1024;
+    options.buffer_count = 2;
+    options.flush_interval = std::chrono::milliseconds((std::max)(gonfig.writer_flush_interval_ms, 1));
+    return options;
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// local
+#include <syncorder/monitoring/histogram.h>
+
+
+/**
+ * @struct AsyncWriterOptions
+ * In-flight memory is bounded by buffer_size * buffer_count.
+ */
+
+struct AsyncWriterOptions {
+    std::size_t buffer_size = std::size_t(1) << 20;
+    std::size_t buffer_count = 4;
+    std::chrono::milliseconds flush_interval{200};  // max time data sits in memory
+};
+
+
+/**
+ * @class AsyncWriter
+ * File writer with its own I/O thread.
+ *
+ * write() copies into the current fill buffer and returns; full buffers are
+ * handed to the writer thread, which issues one large sequential write per
+ * buffer. Partially filled buffers are handed over after flush_interval.
+ * Callers only wait when every buffer is in flight (counted as a stall).
+ */
+
+class AsyncWriter {
+private:
+    struct Buffer {
+        std::unique_ptr<char[]> data;
+        std::size_t size = 0;
+    };
+
+    AsyncWriterOptions options_;
+    std::ofstream file_;
+    std::string path_;
+
+    std::vector<Buffer> buffers_;
+    Buffer* current_ = nullptr;
+    std::deque<Buffer*> pending_;
+    std::vector<Buffer*> free_;
+
+    std::mutex mutex_;
+    std::condition_variable pending_cv_;
+    std::condition_variable free_cv_;
+    bool closing_ = false;
+    std::thread thread_;
+
+    // stats
+    std::atomic<std::uint64_t> bytes_written_{0};
+    std::atomic<std::uint64_t> stalls_{0};
+    std::atomic<bool> failed_{false};
+    Histogram write_us_;
+
+public:
+    AsyncWriter() = default;
+    virtual ~AsyncWriter() { close(); }
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+public:
+    bool open(const std::string& path, const AsyncWriterOptions& options = AsyncWriterOptions(), bool append = false) {
+        close();
+
+        options_ = options;
+        path_ = path;
+
+        // unbuffered: each handed-off buffer reaches the OS as a single write
+        file_.rdbuf()->pubsetbuf(nullptr, 0);
+        file_.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+        if (!file_.is_open()) return false;
+
+        buffers_.clear();
+        buffers_.resize(options_.buffer_count);
+        free_.clear();
+        pending_.clear();
+        for (auto& buffer : buffers_) {
+            buffer.data.reset(new char[options_.buffer_size]);
+            buffer.size = 0;
+            free_.push_back(&buffer);
+        }
+
+        current_ = free_.back();
+        free_.pop_back();
+
+        closing_ = false;
+        failed_ = false;
+        thread_ = std::thread(&AsyncWriter::_run, this);
+        return true;
+    }
+
+    void write(const char* data, std::size_t size) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!thread_.joinable()) return;
+
+        while (size > 0) {
+            if (!current_) {
+                stalls_.fetch_add(1, std::memory_order_relaxed);
+                free_cv_.wait(lock, [this] { return !free_.empty(); });
+                current_ = free_.back();
+                free_.pop_back();
+            }
+
+            std::size_t n = (std::min)(size, options_.buffer_size - current_->size);
+            std::memcpy(current_->data.get() + current_->size, data, n);
+            current_->size += n;
+            data += n;
+            size -= n;
+
+            if (current_->size == options_.buffer_size) _handoff();
+        }
+    }
+
+    void write(const std::string& text) { write(text.data(), text.size()); }
+
+    // hand the partial buffer to the writer thread now, without waiting for the disk
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_ && current_->size > 0) _handoff();
+    }
+
+    // drain everything to disk and stop the writer thread
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable()) return;
+
+            if (current_ && current_->size > 0) _handoff();
+            closing_ = true;
+        }
+        pending_cv_.notify_one();
+        thread_.join();
+
+        file_.close();
+        current_ = nullptr;
+    }
+
+    bool isOpen() const { return file_.is_open(); }
+    bool failed() const { return failed_.load(std::memory_order_relaxed); }
+    const std::string& path() const { return path_; }
+
+    std::uint64_t bytesWritten() const { return bytes_written_.load(std::memory_order_relaxed); }
+    std::uint64_t stalls() const { return stalls_.load(std::memory_order_relaxed); }
+    const Histogram& writeTimeHistogram() const { return write_us_; }
+
+protected:
+    // one handed-off buffer to the file, on the writer thread (the bench slows it down)
+    virtual void _writeBuffer(const char* data, std::size_t size) {
+        file_.write(data, static_cast<std::streamsize>(size));
+        if (!file_.good()) failed_.store(true, std::memory_order_relaxed);
+    }
+
+private:
+    // caller holds mutex_
+    void _handoff() {
+        pending_.push_back(current_);
+        current_ = nullptr;
+
+        if (!free_.empty()) {
+            current_ = free_.back();
+            free_.pop_back();
+        }
+        pending_cv_.notify_one();
+    }
+
+    void _run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        for (;;) {
+            bool ready = pending_cv_.wait_for(lock, options_.flush_interval,
+                                              [this] { return !pending_.empty() || closing_; });
+
+            // interval elapsed with data still in the fill buffer
+            if (!ready && current_ && current_->size > 0) _handoff();
+
+            if (pending_.empty()) {
+                if (closing_) break;
+                continue;
+            }
+
+            Buffer* buffer = pending_.front();
+            pending_.pop_front();
+            lock.unlock();
+
+            auto begin = std::chrono::steady_clock::now();
+            _writeBuffer(buffer->data.get(), buffer->size);
+            auto elapsed = std::chrono::steady_clock::now() - begin;
+
+            write_us_.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+            bytes_written_.fetch_add(buffer->size, std::memory_order_relaxed);
+
+            lock.lock();
+            buffer->size = 0;
+            free_.push_back(buffer);
+            free_cv_.notify_one();
+        }
+    }
+};
+
+
+/**
+ * @class AsyncWriterStream
+ * std::ostream front end for AsyncWriter. flush() and std::endl only move
+ * the text into the writer's fill buffer: lines still reach the disk in
+ * batches, after flush_interval or at close().
+ */
+
+class AsyncWriterStream : public std::ostream {
+private:
+    class StreamBuffer : public std::streambuf {
+    private:
+        AsyncWriter& writer_;
+        char local_[4096];
+
+    public:
+        explicit StreamBuffer(AsyncWriter& writer) : writer_(writer) {
+            setp(local_, local_ + sizeof(local_));
+        }
+
+    protected:
+        int_type overflow(int_type c) override {
+            _drain();
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        // no hand-off per line; the writer thread picks partial buffers up after flush_interval
+        int sync() override {
+            _drain();
+            return 0;
+        }
+
+    private:
+        void _drain() {
+            std::size_t n = static_cast<std::size_t>(pptr() - pbase());
+            if (n > 0) writer_.write(pbase(), n);
+            setp(local_, local_ + sizeof(local_));
+        }
+    };
+
+    AsyncWriter writer_;
+    StreamBuffer buffer_;
+
+public:
+    AsyncWriterStream() : std::ostream(nullptr), buffer_(writer_) {
+        rdbuf(&buffer_);
+    }
+
+    ~AsyncWriterStream() { close(); }
+
+    void open(const std::string& path, std::ios::openmode mode = std::ios::out, const AsyncWriterOptions& options = AsyncWriterOptions()) {
+        if (!writer_.open(path, options, (mode & std::ios::app) != 0)) {
+            setstate(std::ios::failbit);
+            return;
+        }
+        clear();
+    }
+
+    void close() {
+        if (!writer_.isOpen()) return;
+        std::ostream::flush();
+        writer_.close();
+    }
+
+    bool is_open() const { return writer_.isOpen(); }
+    const AsyncWriter& writer() const { return writer_; }
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+
+/**
+ * @class CsvFormatter
+ * Append-only CSV row builder over a reusable byte buffer.
+ *
+ * Numbers go through std::to_chars (locale-free, no allocation), matching
+ * what a default std::ostream prints: fixed(v, p) is `std::fixed <<
+ * std::setprecision(p)`, general(v) is `std::defaultfloat` with precision 6.
+ */
+
+class CsvFormatter {
+private:
+    std::vector<char> buffer_;
+    std::size_t size_ = 0;
+
+public:
+    explicit CsvFormatter(std::size_t reserve = 1 << 16) : buffer_(reserve) {}
+
+public:
+    template<typename T>
+    CsvFormatter& integer(T value) {
+        static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "integer() takes integral or enum values");
+
+        if constexpr (std::is_enum_v<T>) {
+            return integer(static_cast<std::underlying_type_t<T>>(value));
+        } else {
+            _reserve(24);
+            auto result = std::to_chars(_cursor(), _end(), value);
+            size_ = result.ptr - buffer_.data();
+            return *this;
+        }
+    }
+
+    CsvFormatter& fixed(double value, int precision) {
+        return _floating(value, std::chars_format::fixed, precision);
+    }
+
+    CsvFormatter& general(double value, int precision = 6) {
+        return _floating(value, std::chars_format::general, precision);
+    }
+
+    CsvFormatter& text(const char* value, std::size_t length) {
+        _reserve(length);
+        std::memcpy(_cursor(), value, length);
+        size_ += length;
+        return *this;
+    }
+
+    template<std::size_t N>
+    CsvFormatter& text(const char (&value)[N]) {
+        return text(value, N - 1);
+    }
+
+    CsvFormatter& put(char c) {
+        _reserve(1);
+        buffer_[size_++] = c;
+        return *this;
+    }
+
+    CsvFormatter& sep() { return put(','); }
+    CsvFormatter& end() { return put('\n'); }
+
+    const char* data() const { return buffer_.data(); }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void clear() { size_ = 0; }
+
+    // one write of everything buffered so far
+    void flush(std::ostream& out) {
+        if (size_ == 0) return;
+        out.write(buffer_.data(), static_cast<std::streamsize>(size_));
+        size_ = 0;
+    }
+
+private:
+    char* _cursor() { return buffer_.data() + size_; }
+    char* _end() { return buffer_.data() + buffer_.size(); }
+
+    void _reserve(std::size_t n) {
+        if (buffer_.size() - size_ >= n) return;
+
+        std::size_t capacity = buffer_.size() ? buffer_.size() : 64;
+        while (capacity - size_ < n) capacity *= 2;
+        buffer_.resize(capacity);
+    }
+
+    CsvFormatter& _floating(double value, std::chars_format format, int precision) {
+        // enough for any %g and for %f of typical magnitudes; grow and retry otherwise
+        std::size_t need = 64 + static_cast<std::size_t>(precision);
+
+        for (;;) {
+            _reserve(need);
+            auto result = std::to_chars(_cursor(), _end(), value, format, precision);
+            if (result.ec == std::errc()) {
+                size_ = result.ptr - buffer_.data();
+                return *this;
+            }
+            need *= 2;
+        }
+    }
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SYNCORDER_CSV_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// local
+#include <syncorder/io/mapped_file.h>
+
+
+/**
+ * @class CsvScanner
+ * Zero-copy reader over a memory-mapped CSV file.
+ *
+ * Lines and fields are string_views into the mapping. Newlines and commas
+ * are searched 16 bytes at a time (SSE2, scalar elsewhere). select()
+ * projects rows onto a few ascending column indices, and next() splits a
+ * line only up to the last selected one. Numbers are parsed on demand with
+ * std::from_chars, so unselected columns are never converted.
+ *
+ * Lines read the way std::getline reads a text-mode stream: a trailing '\r'
+ * is dropped, and a last line without '\n' still counts.
+ */
+
+class CsvScanner {
+private:
+    MappedFile file_;
+    const char* cursor_ = nullptr;
+    const char* end_ = nullptr;
+
+    std::vector<std::size_t> columns_;       // ascending
+    std::vector<std::string_view> fields_;   // one per selected column
+    std::size_t found_ = 0;                  // selected columns present in the row
+    std::string_view line_;
+
+public:
+    CsvScanner() = default;
+
+    CsvScanner(const CsvScanner&) = delete;
+    CsvScanner& operator=(const CsvScanner&) = delete;
+
+public:
+    bool open(const std::string& path) {
+        if (!file_.openRead(path)) return false;
+
+        cursor_ = file_.data();
+        end_ = file_.data() + file_.size();
+        line_ = {};
+        return true;
+    }
+
+    std::size_t fileSize() const { return file_.size(); }
+
+    // columns in ascending order; none selected leaves rows unsplit
+    void select(std::initializer_list<std::size_t> columns) {
+        columns_.assign(columns.begin(), columns.end());
+        fields_.assign(columns_.size(), std::string_view());
+    }
+
+    // first line, consumed; empty if the file is empty
+    std::string_view header() {
+        std::string_view line;
+        _nextLine(line);
+        return line;
+    }
+
+    // next non-empty line, split onto the selected columns; false at end of file
+    bool next() {
+        std::string_view line;
+        while (_nextLine(line)) {
+            if (line.empty()) continue;
+            line_ = line;
+            _split(line);
+            return true;
+        }
+        return false;
+    }
+
+    std::string_view line() const { return line_; }
+
+    // every selected column is present
+    bool complete() const { return found_ == columns_.size(); }
+
+    // i-th selected column (not the file column)
+    std::string_view field(std::size_t i) const { return i < found_ ? fields_[i] : std::string_view(); }
+
+    // remaining non-empty lines, without splitting them
+    std::size_t countRows() {
+        std::size_t rows = 0;
+        std::string_view line;
+        while (_nextLine(line)) {
+            if (!line.empty()) rows++;
+        }
+        return rows;
+    }
+
+    // the whole field must be a number; false leaves value untouched
+    template<typename T>
+    static bool parse(std::string_view text, T& value) {
+        if (text.empty()) return false;
+
+        T parsed{};
+        auto result = std::from_chars(text.data(), text.data() + text.size(), parsed);
+        if (result.ec != std::errc() || result.ptr != text.data() + text.size()) return false;
+
+        value = parsed;
+        return true;
+    }
+
+private:
+    bool _nextLine(std::string_view& line) {
+        if (cursor_ >= end_) return false;
+
+        const char* newline = _find(cursor_, end_, '\n');
+        const char* line_end = newline;
+        if (line_end > cursor_ && line_end[-1] == '\r') line_end--;
+
+        line = std::string_view(cursor_, static_cast<std::size_t>(line_end - cursor_));
+        cursor_ = (newline < end_) ? newline + 1 : end_;
+        return true;
+    }
+
+    void _split(std::string_view line) {
+        found_ = 0;
+        if (columns_.empty()) return;
+
+        const char* begin = line.data();
+        const char* end = line.data() + line.size();
+        std::size_t column = 0;
+
+        while (found_ < columns_.size()) {
+            const char* comma = _find(begin, end, ',');
+
+            if (column == columns_[found_]) {
+                fields_[found_++] = std::string_view(begin, static_cast<std::size_t>(comma - begin));
+            }
+            if (comma == end) break;
+
+            begin = comma + 1;
+            column++;
+        }
+    }
+
+    // first c in [begin, end), or end
+    static const char* _find(const char* begin, const char* end, char c) {
+        const char* p = begin;
+
+#ifdef SYNCORDER_CSV_SSE2
+        const __m128i needle = _mm_set1_epi8(c);
+        for (; p + 16 <= end; p += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+            if (mask) return p + _lowestBit(mask);
+        }
+#endif
+
+        for (; p < end; ++p) {
+            if (*p == c) return p;
+        }
+        return end;
+    }
+
+    static unsigned _lowestBit(unsigned mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+};
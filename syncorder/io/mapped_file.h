@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+/**
+ * @class MappedFile
+ * Memory-mapped file, either read-only over an existing file or
+ * read-write over a file created with a fixed size.
+ */
+
+class MappedFile {
+private:
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+
+    char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+    bool openRead(const std::string& path) {
+        close();
+
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_, &file_size)) { close(); return false; }
+        size_ = static_cast<std::size_t>(file_size.QuadPart);
+        if (size_ == 0) return true; // empty files cannot be mapped
+
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) { close(); return false; }
+
+        data_ = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return false;
+
+        struct stat st;
+        if (fstat(fd_, &st) != 0) { close(); return false; }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ == 0) return true;
+
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        data_ = (data == MAP_FAILED) ? nullptr : static_cast<char*>(data);
+        if (data_) madvise(data_, size_, MADV_SEQUENTIAL);
+#endif
+
+        if (!data_) { close(); return false; }
+        return true;
+    }
+
+    bool create(const std::string& path, std::size_t size) {
+        close();
+        if (size == 0) return false;
+
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER file_size;
+        file_size.QuadPart = static_cast<LONGLONG>(size);
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(file_size.QuadPart >> 32),
+                                      static_cast<DWORD>(file_size.QuadPart & 0xFFFFFFFF), nullptr);
+        if (!mapping_) { close(); return false; }
+
+        data_ = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size));
+#else
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) return false;
+        if (ftruncate(fd_, static_cast<off_t>(size)) != 0) { close(); return false; }
+
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        data_ = (data == MAP_FAILED) ? nullptr : static_cast<char*>(data);
+#endif
+
+        if (!data_) { close(); return false; }
+        size_ = size;
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap(data_, size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool isOpen() const {
+#ifdef _WIN32
+        return file_ != INVALID_HANDLE_VALUE;
+#else
+        return fd_ >= 0;
+#endif
+    }
+
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+};
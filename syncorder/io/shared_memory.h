@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+/**
+ * @class SharedMemory
+ * Named shared memory region: a pagefile-backed file mapping on Windows
+ * ("Local\<name>"), POSIX shm elsewhere ("/<name>"). The creator owns the
+ * name; readers open it read-only.
+ */
+
+class SharedMemory {
+private:
+#ifdef _WIN32
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+    bool owner_ = false;
+    std::string name_;
+#endif
+
+    char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+public:
+    SharedMemory() = default;
+    ~SharedMemory() { close(); }
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+public:
+    bool create(const std::string& name, std::size_t size) {
+        close();
+        if (size == 0) return false;
+
+#ifdef _WIN32
+        std::string path = "Local\\" + name;
+        mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32),
+                                      static_cast<DWORD>(size & 0xFFFFFFFF), path.c_str());
+        if (!mapping_) return false;
+
+        data_ = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size));
+#else
+        name_ = "/" + name;
+        fd_ = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) return false;
+        owner_ = true;
+        if (ftruncate(fd_, static_cast<off_t>(size)) != 0) { close(); return false; }
+
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        data_ = (data == MAP_FAILED) ? nullptr : static_cast<char*>(data);
+#endif
+
+        if (!data_) { close(); return false; }
+        size_ = size;
+        return true;
+    }
+
+    bool openRead(const std::string& name) {
+        close();
+
+#ifdef _WIN32
+        std::string path = "Local\\" + name;
+        mapping_ = OpenFileMappingA(FILE_MAP_READ, FALSE, path.c_str());
+        if (!mapping_) return false;
+
+        data_ = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (!data_) { close(); return false; }
+
+        MEMORY_BASIC_INFORMATION info;
+        if (VirtualQuery(data_, &info, sizeof(info)) == 0) { close(); return false; }
+        size_ = static_cast<std::size_t>(info.RegionSize);
+#else
+        name_ = "/" + name;
+        fd_ = shm_open(name_.c_str(), O_RDONLY, 0);
+        if (fd_ < 0) return false;
+
+        struct stat st;
+        if (fstat(fd_, &st) != 0 || st.st_size == 0) { close(); return false; }
+        size_ = static_cast<std::size_t>(st.st_size);
+
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        data_ = (data == MAP_FAILED) ? nullptr : static_cast<char*>(data);
+        if (!data_) { close(); return false; }
+#endif
+
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        mapping_ = nullptr;
+#else
+        if (data_) munmap(data_, size_);
+        if (fd_ >= 0) ::close(fd_);
+        if (owner_) shm_unlink(name_.c_str());
+        fd_ = -1;
+        owner_ = false;
+#endif
+
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool isOpen() const { return data_ != nullptr; }
+
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+};
@@ -17,6 +17,8 @@
 
 // Project includes
 #include "../gonfig/gonfig.h"
+#include "../io/async_writer.h"
+#include "../gonfig/writer_options.h"
 
 #pragma comment(lib, "pdh.lib")
 #pragma comment(lib, "psapi.lib")
@@ -38,8 +40,8 @@ private:
     std::thread monitor_thread_;
     std::atomic<bool> running_{false};
 
-    // File logging
-    std::ofstream log_file_;
+    // File logging (lines reach the disk from the writer thread)
+    AsyncWriterStream log_file_;
 
     // Performance counters
     PDH_HQUERY query_;
@@ -73,7 +75,7 @@ public:
 
         // Ensure output directory exists
         std::filesystem::create_directories(gonfig.output_path);
-        log_file_.open(log_path, std::ios::out | std::ios::app);
+        log_file_.open(log_path, std::ios::out | std::ios::app, logWriterOptions());
 
         if (!log_file_.is_open()) {
             std::cout << "[ERROR] Failed to create CPU/RAM monitor log file: " << log_path << "\n";
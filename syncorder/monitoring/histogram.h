@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cmath>
+#include <ostream>
+#include <string>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+/**
+ * @class Histogram
+ * Fixed-memory log-linear histogram of non-negative integers: exact below 8,
+ * then 8 sub-buckets per power of two (<= 12.5% relative error).
+ *
+ * record() is meant for a single writer thread and takes no locks; any
+ * thread may read concurrently and sees a consistent-enough snapshot.
+ */
+
+class Histogram {
+public:
+    static constexpr int SUB_BITS = 3;
+    static constexpr std::size_t SUB_COUNT = std::size_t(1) << SUB_BITS;
+    static constexpr std::size_t BUCKETS = 64 * SUB_COUNT;
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKETS> counts_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+    std::atomic<std::uint64_t> max_{0};
+
+public:
+    void record(std::uint64_t value) noexcept {
+        _bump(counts_[_index(value)], 1);
+        _bump(count_, 1);
+        _bump(sum_, value);
+
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    std::uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+    std::uint64_t maximum() const noexcept { return max_.load(std::memory_order_relaxed); }
+
+    double mean() const noexcept {
+        std::uint64_t n = count();
+        return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    // upper bound of the bucket holding the q-th quantile, clamped to maximum()
+    std::uint64_t quantile(double q) const noexcept {
+        std::uint64_t n = count();
+        if (n == 0) return 0;
+
+        std::uint64_t target = static_cast<std::uint64_t>(std::ceil(q * n));
+        if (target == 0) target = 1;
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                std::uint64_t upper = bucketUpper(i);
+                return upper < maximum() ? upper : maximum();
+            }
+        }
+        return maximum();
+    }
+
+    // merge-on-read: accumulate another histogram into this one, which must have no concurrent writer
+    void add(const Histogram& other) noexcept {
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            std::uint64_t n = other.bucketCount(i);
+            if (n) _bump(counts_[i], n);
+        }
+        _bump(count_, other.count());
+        _bump(sum_, other.sum_.load(std::memory_order_relaxed));
+
+        if (other.maximum() > maximum()) {
+            max_.store(other.maximum(), std::memory_order_relaxed);
+        }
+    }
+
+    std::uint64_t bucketCount(std::size_t index) const noexcept {
+        return counts_[index].load(std::memory_order_relaxed);
+    }
+
+    static std::uint64_t bucketLower(std::size_t index) noexcept {
+        if (index < SUB_COUNT) return index;
+
+        std::size_t shift = (index >> SUB_BITS) - 1;
+        return (SUB_COUNT + (index & (SUB_COUNT - 1))) << shift;
+    }
+
+    static std::uint64_t bucketUpper(std::size_t index) noexcept {
+        if (index < SUB_COUNT) return index;
+
+        std::size_t shift = (index >> SUB_BITS) - 1;
+        return bucketLower(index) + ((std::uint64_t(1) << shift) - 1);
+    }
+
+    // "name count=.. mean=.. p50=.. p95=.. p99=.. max=.." followed by one "bucket" line per non-empty bucket
+    void write(std::ostream& out, const std::string& name, bool buckets = true) const {
+        out << name
+            << " count=" << count()
+            << " mean=" << mean()
+            << " p50=" << quantile(0.50)
+            << " p95=" << quantile(0.95)
+            << " p99=" << quantile(0.99)
+            << " max=" << maximum() << "\n";
+
+        if (!buckets) return;
+
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            std::uint64_t n = bucketCount(i);
+            if (n == 0) continue;
+            out << name << " bucket " << bucketLower(i) << "-" << bucketUpper(i) << " " << n << "\n";
+        }
+    }
+
+private:
+    static void _bump(std::atomic<std::uint64_t>& counter, std::uint64_t by) noexcept {
+        // single writer: plain load/store, no locked read-modify-write
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    static std::size_t _index(std::uint64_t value) noexcept {
+        if (value < SUB_COUNT) return static_cast<std::size_t>(value);
+
+        std::size_t msb = _msb(value);
+        std::size_t shift = msb - SUB_BITS;
+        return ((shift + 1) << SUB_BITS) + static_cast<std::size_t>((value >> shift) & (SUB_COUNT - 1));
+    }
+
+    static std::size_t _msb(std::uint64_t value) noexcept {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return index;
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+};
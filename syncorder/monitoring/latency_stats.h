@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// local
+#include <syncorder/monitoring/histogram.h>
+
+
+/**
+ * @class LatencyStats
+ * Constant-memory latency and inter-arrival statistics for one stream.
+ *
+ * Every writer thread takes its own Recorder (a pair of Histograms) and
+ * records without locks; readers merge all recorders into a snapshot.
+ * Values are kept in microseconds.
+ */
+
+class LatencyStats {
+public:
+    static constexpr std::size_t MAX_RECORDERS = 8;
+
+    class Recorder {
+    private:
+        Histogram latency_us_;
+        Histogram interval_us_;
+        std::atomic<std::uint64_t> negative_{0};  // arrival before the device timestamp (clock skew)
+        double last_arrival_ = 0.0;               // writer only
+
+        friend class LatencyStats;
+
+    public:
+        // latency and arrival in ms; the first arrival only starts the interval clock
+        void record(double latency, double arrival) noexcept {
+            if (latency < 0.0) {
+                negative_.store(negative_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                latency = 0.0;
+            }
+            latency_us_.record(static_cast<std::uint64_t>(latency * 1000.0));
+
+            if (last_arrival_ > 0.0 && arrival >= last_arrival_) {
+                interval_us_.record(static_cast<std::uint64_t>((arrival - last_arrival_) * 1000.0));
+            }
+            last_arrival_ = arrival;
+        }
+    };
+
+    struct Snapshot {
+        Histogram latency_us;
+        Histogram interval_us;
+        std::uint64_t negative = 0;
+    };
+
+private:
+    std::array<Recorder, MAX_RECORDERS> recorders_;
+    std::atomic<std::size_t> claimed_{0};
+
+public:
+    // one per writer thread, kept for its lifetime; nullptr once all are taken
+    Recorder* recorder() noexcept {
+        std::size_t index = claimed_.fetch_add(1, std::memory_order_relaxed);
+        return index < MAX_RECORDERS ? &recorders_[index] : nullptr;
+    }
+
+    // merge every recorder into out (which should start empty)
+    void merge(Snapshot& out) const noexcept {
+        std::size_t claimed = claimed_.load(std::memory_order_relaxed);
+        if (claimed > MAX_RECORDERS) claimed = MAX_RECORDERS;
+
+        for (std::size_t i = 0; i < claimed; ++i) {
+            out.latency_us.add(recorders_[i].latency_us_);
+            out.interval_us.add(recorders_[i].interval_us_);
+            out.negative += recorders_[i].negative_.load(std::memory_order_relaxed);
+        }
+    }
+};
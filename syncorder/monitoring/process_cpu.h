@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+
+/**
+ * @brief CPU time used by this process so far, all threads, in seconds
+ * Take the difference of two calls over a wall-clock interval for a load.
+ */
+
+inline double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+
+    auto seconds = [](const FILETIME& t) {
+        return static_cast<double>((static_cast<std::uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7;
+    };
+    return seconds(kernel) + seconds(user);
+#else
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
@@ -12,14 +12,65 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <librealsense2/rs.hpp>
 #include "../gonfig/gonfig.h"
+#include "../io/async_writer.h"
+#include "../gonfig/writer_options.h"
+#include "latency_stats.h"
+
+
+/**
+ * @struct RealsenseFrameCounters
+ * Per-frame figures written by one thread (the broker) with relaxed stores,
+ * no locks and no read-modify-write; the monitor thread samples them.
+ */
+
+struct RealsenseFrameCounters {
+    static constexpr double GAP_MS = 50.0;  // arrival gaps above this count as drops
+
+    alignas(64) std::atomic<std::uint64_t> frames{0};
+    std::atomic<std::uint64_t> gaps{0};
+    std::atomic<double> latency_sum{0.0};    // ms
+    std::atomic<double> min_latency{999999.0};
+    std::atomic<double> max_latency{0.0};
+    std::atomic<double> max_gap{0.0};        // ms
+    std::atomic<double> last_timestamp{0.0};
+    std::atomic<double> last_latency{0.0};
+
+    // writer only
+    double last_arrival_ = 0.0;
+    LatencyStats::Recorder* recorder_ = nullptr;
+
+    void record(double arrival, double timestamp) noexcept {
+        double latency = arrival - timestamp;
+        if (recorder_) recorder_->record(latency, arrival);
+
+        frames.store(frames.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        latency_sum.store(latency_sum.load(std::memory_order_relaxed) + latency, std::memory_order_relaxed);
+        if (latency < min_latency.load(std::memory_order_relaxed)) min_latency.store(latency, std::memory_order_relaxed);
+        if (latency > max_latency.load(std::memory_order_relaxed)) max_latency.store(latency, std::memory_order_relaxed);
+
+        if (last_arrival_ > 0.0) {
+            double gap = arrival - last_arrival_;
+            if (gap > GAP_MS) {
+                gaps.store(gaps.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                if (gap > max_gap.load(std::memory_order_relaxed)) max_gap.store(gap, std::memory_order_relaxed);
+            }
+        }
+        last_arrival_ = arrival;
+
+        last_timestamp.store(timestamp, std::memory_order_relaxed);
+        last_latency.store(latency, std::memory_order_relaxed);
+    }
+};
+
 
 class RealsenseMonitor {
 private:
     std::thread monitor_thread_;
     std::atomic<bool> running_{false};
-    std::ofstream log_file_;
+    AsyncWriterStream log_file_;
     std::mutex log_mutex_;
 
     // Realsense-specific monitoring
@@ -39,14 +90,19 @@ private:
     std::chrono::steady_clock::time_point last_frame_time_;
     std::chrono::steady_clock::time_point start_time_;
 
+    // frame feed, sampled once a second by the monitor thread
+    RealsenseFrameCounters counters_;
+    std::uint64_t polled_frames_ = 0;
+    std::uint64_t polled_gaps_ = 0;
+    double polled_latency_sum_ = 0.0;
+
     // Recording session metrics
     std::atomic<int> frame_drops_{0};
     std::atomic<int> queue_overflows_{0};
     std::atomic<double> max_latency_{0.0};
     std::atomic<double> min_latency_{999999.0};
     std::atomic<float> max_temperature_{0.0f};
-    std::vector<double> latency_history_;
-    std::mutex latency_mutex_;
+    LatencyStats latency_stats_;  // constant memory, one recorder per writer thread
 
     // Recording quality tracking
     std::atomic<int> color_frame_count_{0};
@@ -67,7 +123,7 @@ public:
             std::string log_path = gonfig.output_path + "realsense_monitor_" + std::to_string(time_t) + ".log";
 
             std::filesystem::create_directories(gonfig.output_path);
-            log_file_.open(log_path, std::ios::out | std::ios::app);
+            log_file_.open(log_path, std::ios::out | std::ios::app, logWriterOptions());
 
             if (log_file_.is_open()) {
                 running_ = true;
@@ -103,6 +159,9 @@ public:
             _logDeviceEvent("THREAD_SHUTDOWN", "Monitor thread stopped gracefully in " + std::to_string(duration) + "ms");
         }
 
+        // frames recorded since the last tick
+        _pollFrames();
+
         // Final device status check before shutdown
         _logDeviceShutdownStatus();
 
@@ -117,45 +176,21 @@ public:
         stop();
     }
 
-    // Public methods for external components to report events
-    void onFrameReceived(double timestamp, double latency) {
-        frame_count_++;
-
-        auto now = std::chrono::steady_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_frame_time_).count();
-
-        if (duration > 0) {
-            last_fps_ = 1000.0 / duration;
-        }
-
-        // Update latency metrics
-        avg_latency_ = latency;
-        if (latency > max_latency_.load()) {
-            max_latency_ = latency;
-        }
-        if (latency < min_latency_.load()) {
-            min_latency_ = latency;
-        }
-
-        // Store latency history for analysis (keep last 1000 samples)
-        {
-            std::lock_guard<std::mutex> lock(latency_mutex_);
-            latency_history_.push_back(latency);
-            if (latency_history_.size() > 1000) {
-                latency_history_.erase(latency_history_.begin());
-            }
-        }
+    RealsenseMonitor() {
+        counters_.recorder_ = latency_stats_.recorder();
+    }
 
-        // Detect frame drops (gaps > 50ms indicate potential drops)
-        if (duration > 50) {
-            frame_drops_++;
-            _logRecordingEvent("FRAME_DROP_DETECTED", "Gap of " + std::to_string(duration) + "ms detected");
-        }
+    // written by the broker thread only
+    RealsenseFrameCounters& counters() {
+        return counters_;
+    }
 
-        last_frame_time_ = now;
-        _logFrameEvent(timestamp, latency);
+    // other writer threads take their own recorder
+    LatencyStats& latencyStats() {
+        return latency_stats_;
     }
 
+    // Public methods for external components to report events
     void onError(const std::string& error_msg) {
         error_count_++;
         _logError(error_msg);
@@ -196,6 +231,7 @@ private:
         std::this_thread::sleep_for(std::chrono::seconds(1));
 
         while (running_) {
+            _pollFrames();
             _updateDeviceStatus();
             _updateTemperature();
             _logPeriodicStats();
@@ -204,6 +240,43 @@ private:
         }
     }
 
+    // fold what the broker recorded since the last poll into the session metrics
+    void _pollFrames() {
+        std::uint64_t frames = counters_.frames.load(std::memory_order_relaxed);
+        std::uint64_t gaps = counters_.gaps.load(std::memory_order_relaxed);
+        double latency_sum = counters_.latency_sum.load(std::memory_order_relaxed);
+
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration<double>(now - last_frame_time_).count();
+        std::uint64_t new_frames = frames - polled_frames_;
+
+        frame_count_ = static_cast<int>(frames);
+        if (elapsed > 0.0) last_fps_ = new_frames / elapsed;
+        min_latency_ = counters_.min_latency.load(std::memory_order_relaxed);
+        max_latency_ = counters_.max_latency.load(std::memory_order_relaxed);
+
+        if (new_frames > 0) {
+            avg_latency_ = (latency_sum - polled_latency_sum_) / new_frames;
+        }
+
+        if (gaps > polled_gaps_) {
+            frame_drops_ += static_cast<int>(gaps - polled_gaps_);
+            _logRecordingEvent("FRAME_DROP_DETECTED", std::to_string(gaps - polled_gaps_) + " gap(s) over "
+                + std::to_string(static_cast<int>(RealsenseFrameCounters::GAP_MS)) + "ms, longest so far "
+                + std::to_string(static_cast<int>(counters_.max_gap.load(std::memory_order_relaxed))) + "ms");
+        }
+
+        if (new_frames > 0) {
+            _logFrameEvent(counters_.last_timestamp.load(std::memory_order_relaxed),
+                           counters_.last_latency.load(std::memory_order_relaxed));
+        }
+
+        polled_frames_ = frames;
+        polled_gaps_ = gaps;
+        polled_latency_sum_ = latency_sum;
+        last_frame_time_ = now;
+    }
+
     bool _initializeDevices() {
         try {
             auto device_list = ctx_.query_devices();
@@ -335,7 +408,7 @@ private:
 
     void _logFrameEvent(double timestamp, double latency) {
         static int frame_log_counter = 0;
-        if (++frame_log_counter % 100 == 0) { // Log every 100th frame to avoid spam
+        if (++frame_log_counter % 2 == 0) { // Every 2 seconds, roughly the old every-100th-frame rate
             auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 
             std::lock_guard<std::mutex> lock(log_mutex_);
@@ -459,6 +532,14 @@ private:
         }
     }
 
+    // "<label> - P50: ..ms, P95: ..ms, P99: ..ms, Max: ..ms" from a microsecond histogram
+    void _logQuantiles(std::time_t now, const std::string& label, const Histogram& us) {
+        log_file_ << "[" << now << "] " << label << " - P50: " << std::fixed << std::setprecision(2) << us.quantile(0.50) / 1000.0
+                  << "ms, P95: " << us.quantile(0.95) / 1000.0
+                  << "ms, P99: " << us.quantile(0.99) / 1000.0
+                  << "ms, Max: " << us.maximum() / 1000.0 << "ms\n";
+    }
+
     void _logRecordingEvent(const std::string& event_type, const std::string& details) {
         auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 
@@ -489,38 +570,21 @@ private:
             log_file_ << "[" << now << "] Max temperature reached: " << max_temperature_.load() << "°C\n";
             log_file_ << "[" << now << "] Latency - Min: " << min_latency_.load() << "ms, Max: " << max_latency_.load() << "ms\n";
 
-            // Calculate latency statistics
+            // latency and frame interval distributions for the whole session
             {
-                std::lock_guard<std::mutex> latency_lock(latency_mutex_);
-                if (!latency_history_.empty()) {
-                    double sum = 0.0;
-                    for (double latency : latency_history_) {
-                        sum += latency;
-                    }
-                    double avg = sum / latency_history_.size();
-
-                    // Calculate standard deviation
-                    double variance = 0.0;
-                    for (double latency : latency_history_) {
-                        variance += (latency - avg) * (latency - avg);
-                    }
-                    variance /= latency_history_.size();
-                    double std_dev = std::sqrt(variance);
+                LatencyStats::Snapshot stats;
+                latency_stats_.merge(stats);
 
+                if (stats.latency_us.count() > 0) {
                     log_file_ << "[" << now << "] Latency analysis - Average: " << std::fixed << std::setprecision(2)
-                              << avg << "ms, Std Dev: " << std_dev << "ms\n";
-
-                    // Calculate percentiles
-                    std::vector<double> sorted_latency = latency_history_;
-                    std::sort(sorted_latency.begin(), sorted_latency.end());
-
-                    size_t p50_idx = static_cast<size_t>(sorted_latency.size() * 0.5);
-                    size_t p95_idx = static_cast<size_t>(sorted_latency.size() * 0.95);
-                    size_t p99_idx = static_cast<size_t>(sorted_latency.size() * 0.99);
-
-                    log_file_ << "[" << now << "] Latency percentiles - P50: " << sorted_latency[p50_idx]
-                              << "ms, P95: " << sorted_latency[p95_idx]
-                              << "ms, P99: " << sorted_latency[p99_idx] << "ms\n";
+                              << stats.latency_us.mean() / 1000.0 << "ms over " << stats.latency_us.count() << " frames\n";
+                    _logQuantiles(now, "Latency percentiles", stats.latency_us);
+                    if (stats.negative > 0) {
+                        log_file_ << "[" << now << "] Latency below zero (clock skew, counted as 0): " << stats.negative << " frames\n";
+                    }
+                }
+                if (stats.interval_us.count() > 0) {
+                    _logQuantiles(now, "Frame interval percentiles", stats.interval_us);
                 }
             }
 
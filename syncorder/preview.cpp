@@ -0,0 +1,83 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <string>
+
+// local
+#include <syncorder/gonfig/gonfig.h>
+#include <syncorder/devices/common/preview_channel.h>
+
+
+/**
+ * @brief write a preview as binary PPM (rgb8 only)
+ */
+
+bool writePpm(const std::string& path, const PreviewImage& image) {
+    if (image.channels != 3 || image.empty()) return false;
+
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+    return file.good();
+}
+
+
+/**
+ * @main
+ * Example consumer of the recorder's shared-memory live preview.
+ *
+ *   preview.exe [--preview_shm_name SyncorderPreview] [--dump <dir>]
+ *
+ * Prints what arrives once a second; with --dump, writes the next color and
+ * depth previews as color.ppm / depth.ppm into <dir> and exits.
+ */
+
+int main(int argc, char* argv[]) {
+    gonfig = Config::parseArgs(argc, argv);
+
+    std::string dump_dir;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--dump") dump_dir = argv[i + 1];
+    }
+
+    SharedPreviewReader reader;
+    while (!reader.open(gonfig.preview_shm_name)) {
+        std::cout << "[INFO] Waiting for preview \"" << gonfig.preview_shm_name << "\"...\n";
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    std::cout << "[INFO] Connected to preview \"" << gonfig.preview_shm_name << "\"\n";
+
+    PreviewImage color;
+    PreviewImage depth;
+    int color_count = 0;
+    int depth_count = 0;
+    bool have_color = false;
+    bool have_depth = false;
+    auto last_report = std::chrono::steady_clock::now();
+
+    while (true) {
+        if (reader.read(PreviewStream::Color, color)) { color_count++; have_color = true; }
+        if (reader.read(PreviewStream::Depth, depth)) { depth_count++; have_depth = true; }
+
+        if (!dump_dir.empty() && have_color && have_depth) {
+            bool ok = writePpm(dump_dir + "/color.ppm", color) && writePpm(dump_dir + "/depth.ppm", depth);
+            std::cout << (ok ? "[INFO] Wrote " : "[ERROR] Failed to write ") << dump_dir << "/color.ppm, depth.ppm\n";
+            return ok ? 0 : 1;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_report >= std::chrono::seconds(1)) {
+            std::cout << "[Preview] color #" << color.frame_number << " " << color.width << "x" << color.height
+                      << " (" << color_count << "/s), depth #" << depth.frame_number << " " << depth.width << "x" << depth.height
+                      << " (" << depth_count << "/s)\n";
+            color_count = 0;
+            depth_count = 0;
+            last_report = now;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
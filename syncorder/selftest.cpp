@@ -0,0 +1,556 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// local
+#include <syncorder/devices/common/broker_base.h>
+#include <syncorder/devices/common/clock_sync.h>
+#include <syncorder/devices/common/preview_base.h>
+#include <syncorder/gonfig/gonfig.h>
+#include <syncorder/io/csv_scanner.h>
+#include <syncorder/monitoring/process_cpu.h>
+#include <syncorder/devices/tobii/buffer.cpp>
+#include <syncorder/devices/tobii/callback.cpp>
+#include <syncorder/devices/tobii/broker.cpp>
+#include <syncorder/devices/tobii/session_rate.h>
+#include <syncorder/devices/tobii/synthetic_source.cpp>
+
+
+/**
+ * @struct AllocationCounter
+ * Counts global operator new calls, from any thread, while enabled.
+ */
+
+struct AllocationCounter {
+    static inline std::atomic<bool> enabled{false};
+    static inline std::atomic<std::size_t> count{0};
+
+    static void begin() {
+        count.store(0);
+        enabled.store(true);
+    }
+
+    static std::size_t end() {
+        enabled.store(false);
+        return count.load();
+    }
+};
+
+void* operator new(std::size_t size) {
+    if (AllocationCounter::enabled.load(std::memory_order_relaxed)) {
+        AllocationCounter::count.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+
+/**
+ * @class CountingGazeBroker
+ * Broker that only reads the samples in place and counts them.
+ */
+
+class CountingGazeBroker : public TBBroker<TobiiBufferData> {
+private:
+    std::atomic<std::size_t> processed_{0};
+    std::int64_t checksum_{0};
+
+public:
+    std::size_t processed() const {
+        return processed_.load(std::memory_order_acquire);
+    }
+
+    std::int64_t checksum() const {
+        return checksum_;
+    }
+
+protected:
+    void _process(const TobiiBufferData& data) override {
+        _processBatch(&data, 1);
+    }
+
+    void _processBatch(const TobiiBufferData* data, std::size_t count) override {
+        for (std::size_t i = 0; i < count; ++i) checksum_ += data[i].system_time_stamp;
+        processed_.fetch_add(count, std::memory_order_release);
+    }
+};
+
+
+/**
+ * @brief enqueue -> _frontBulk -> _popBulk must not allocate once running
+ */
+
+bool checkDequeueAllocations(std::ostream& log) {
+    constexpr std::size_t WARMUP = 4096;
+    constexpr std::size_t SAMPLES = 200000;
+
+    TobiiBuffer buffer;
+    buffer.setCapacity(ringCapacity(120.0, 2.0));
+
+    CountingGazeBroker broker;
+    broker.setup(&buffer);
+    broker.start();
+    buffer.start();
+
+    std::size_t sent = 0;
+    auto push = [&](std::size_t count) {
+        TobiiBufferData sample{};
+        for (std::size_t i = 0; i < count; ++i) {
+            // keep the ring from overflowing: this is about the dequeue path, not drops
+            while (buffer.size() + 1 >= buffer.capacity()) std::this_thread::yield();
+
+            sample.system_time_stamp = static_cast<std::int64_t>(sent++);
+            buffer.enqueue(sample);
+        }
+        while (broker.processed() < sent) std::this_thread::yield();
+    };
+
+    push(WARMUP);
+
+    AllocationCounter::begin();
+    push(SAMPLES);
+    std::size_t allocations = AllocationCounter::end();
+
+    buffer.stop();
+    broker.stop();
+
+    log << "  " << SAMPLES << " samples in steady state, " << allocations << " allocations"
+        << " (ring " << buffer.capacity() << ", processed " << broker.processed() << ")\n";
+    return allocations == 0 && broker.processed() == sent;
+}
+
+
+/**
+ * @brief spill policy comes up in a session folder that does not exist yet
+ *
+ * TobiiManager configures the buffer before the broker creates
+ * output_path/tobii/, so the spill file's directory must not be assumed.
+ * The ring is then overfilled with no consumer running, and everything,
+ * ring and spill, must reach the broker exactly once.
+ */
+
+bool checkSpillPolicy(std::ostream& log) {
+    constexpr std::size_t OVERFLOW_COUNT = 500;
+
+    std::string output = (std::filesystem::temp_directory_path() / "syncorder_selftest_spill").generic_string() + "/";
+    std::filesystem::remove_all(output);
+
+    std::size_t sent = 0;
+    std::int64_t expected = 0;
+    bool configured = false;
+    OverflowPolicy policy = OverflowPolicy::DropNewest;
+    OverflowStats stats;
+    std::size_t processed = 0;
+    std::int64_t checksum = 0;
+    {
+        TobiiBuffer buffer;
+        buffer.setCapacity(ringCapacity(120.0, 1.0));
+
+        OverflowOptions overflow;
+        overflow.spill_path = output + "tobii/overflow.spill";
+        configured = buffer.setOverflowPolicy(OverflowPolicy::Spill, overflow);
+        policy = buffer.overflowPolicy();
+
+        CountingGazeBroker broker;
+        broker.setup(&buffer);
+        buffer.start();
+
+        TobiiBufferData sample{};
+        for (std::size_t i = 0; i < buffer.capacity() + OVERFLOW_COUNT; ++i) {
+            sample.system_time_stamp = static_cast<std::int64_t>(i);
+            if (buffer.enqueue(sample)) {
+                sent++;
+                expected += sample.system_time_stamp;
+            }
+        }
+
+        broker.start();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (broker.processed() < sent && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+
+        buffer.stop();
+        broker.stop();
+        buffer.discardRemaining();
+
+        stats = buffer.overflowStats();
+        processed = broker.processed();
+        checksum = broker.checksum();
+    }
+    std::filesystem::remove_all(output);
+
+    log << "  policy " << overflowPolicyName(policy) << (configured ? "" : " (spill unavailable)")
+        << "; " << sent << " accepted, " << stats.spilled << " spilled, " << processed << " processed"
+        << ", dropped " << (stats.dropped_newest + stats.dropped_oldest) << ", discarded " << stats.discarded << "\n";
+
+    return configured && policy == OverflowPolicy::Spill
+        && stats.spilled > 0 && stats.dropped_newest == 0 && stats.dropped_oldest == 0 && stats.discarded == 0
+        && processed == sent && checksum == expected;
+}
+
+
+/**
+ * @brief TripleBuffer hands the reader whole, ever newer values while the
+ * writer never waits on it, and republishing a preview reuses its pixels
+ *
+ * Every PACE publishes the writer waits until the reader has acquired a
+ * slot, then goes straight on writing while the reader is still checking
+ * that slot. This keeps the two sides interleaved even on one core, where
+ * a free-running reader only gets a look in once per time slice. The
+ * handshake only paces the test; TripleBuffer itself is never locked.
+ */
+
+bool checkPreviewSlot(std::ostream& log) {
+    constexpr std::uint64_t VALUES = 400000;
+    constexpr std::uint64_t PACE = 4;
+    constexpr std::uint64_t MIN_READS = VALUES / PACE;
+
+    struct Value {
+        std::uint64_t sequence = 0;
+        std::array<std::uint64_t, 255> payload{};  // every word equals sequence unless torn
+    };
+
+    TripleBuffer<Value> slot;
+    std::atomic<bool> writing{true};
+    std::atomic<std::uint64_t> published{0};
+    std::atomic<std::uint64_t> acquired{0};
+
+    std::mutex pace_mutex;
+    std::condition_variable pace_cv;
+
+    std::thread writer([&]() {
+        std::uint64_t seen = 0;
+        for (std::uint64_t n = 1; n <= VALUES; ++n) {
+            Value& value = slot.back();
+            value.sequence = n;
+            value.payload.fill(n);
+            slot.publish();
+            published.store(n, std::memory_order_release);
+
+            if (n % PACE == 0) {
+                std::unique_lock<std::mutex> lock(pace_mutex);
+                pace_cv.notify_all();
+                pace_cv.wait(lock, [&] { return acquired.load(std::memory_order_acquire) != seen; });
+                seen = acquired.load(std::memory_order_acquire);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(pace_mutex);
+        writing.store(false, std::memory_order_release);
+        pace_cv.notify_all();
+    });
+
+    std::uint64_t reads = 0;
+    std::uint64_t overlapped = 0;  // the writer published while this read was being checked
+    std::uint64_t last = 0;
+    std::uint64_t torn = 0;
+    std::uint64_t backwards = 0;
+    auto read = [&]() {
+        if (!slot.acquire()) return false;
+
+        std::uint64_t before = published.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(pace_mutex);
+            acquired.fetch_add(1, std::memory_order_release);
+        }
+        pace_cv.notify_all();
+
+        // the writer is free to publish again from here on
+        const Value& value = slot.front();
+        for (std::uint64_t word : value.payload) {
+            if (word != value.sequence) { torn++; break; }
+        }
+        if (value.sequence <= last) backwards++;
+        last = value.sequence;
+        reads++;
+
+        if (published.load(std::memory_order_acquire) != before) overlapped++;
+        return true;
+    };
+
+    while (writing.load(std::memory_order_acquire)) {
+        if (read()) continue;
+
+        // nothing new yet: sleep until the writer publishes more or finishes
+        std::uint64_t seen = published.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(pace_mutex);
+        pace_cv.wait(lock, [&] {
+            return published.load(std::memory_order_acquire) != seen || !writing.load(std::memory_order_acquire);
+        });
+    }
+    writer.join();
+    read();
+
+    log << "  " << VALUES << " published, " << reads << " read (" << overlapped << " overlapping a publish)"
+        << ", last " << last << ", torn " << torn << ", out of order " << backwards << "\n";
+    bool slot_ok = (last == VALUES) && torn == 0 && backwards == 0 && reads >= MIN_READS;
+
+    // 640x480 rgb8 into a 320 wide preview; warm up until every slot went through writer and reader
+    constexpr int WIDTH = 640;
+    constexpr int HEIGHT = 480;
+    std::vector<std::uint8_t> frame(static_cast<std::size_t>(WIDTH) * HEIGHT * 3, 7);
+
+    PreviewSlot previews;
+    for (int i = 0; i < 4; ++i) {
+        downscalePreview(previews.back(), frame.data(), WIDTH, HEIGHT, 3, WIDTH * 3, 320);
+        previews.publish();
+        previews.acquire();
+    }
+
+    AllocationCounter::begin();
+    for (int i = 0; i < 1000; ++i) {
+        downscalePreview(previews.back(), frame.data(), WIDTH, HEIGHT, 3, WIDTH * 3, 320);
+        previews.publish();
+        previews.acquire();
+    }
+    std::size_t allocations = AllocationCounter::end();
+
+    log << "  1000 preview publishes (" << previews.front().width << "x" << previews.front().height
+        << "), " << allocations << " allocations\n";
+    return slot_ok && allocations == 0;
+}
+
+
+/**
+ * @brief ClockEstimator tracks a drifting device clock through noisy,
+ * bracketed time-sync samples
+ *
+ * 30 minutes of 1 Hz samples of a device clock running 50 ppm fast. Each
+ * round trip has a random queueing delay on either leg, and every 20th
+ * sample is delayed by several ms more, as on a busy USB host.
+ */
+
+bool checkClockDrift(std::ostream& log) {
+    constexpr double SKEW_PPM = 50.0;
+    constexpr int SAMPLES = 30 * 60;
+    constexpr std::int64_t PERIOD_US = 1000000;
+    constexpr int SETTLE = 60;  // samples before the fit is held to the bound
+    constexpr double MAX_ERROR_US = 200.0;
+
+    const std::int64_t device_start = 1234567890123LL;
+    const std::int64_t system_start = 987654321000LL;
+    auto system_at = [&](std::int64_t device_us) {
+        double elapsed = static_cast<double>(device_us - device_start);
+        return system_start + static_cast<std::int64_t>(std::llround(elapsed * (1.0 + SKEW_PPM * 1e-6)));
+    };
+
+    std::mt19937 random(17);
+    std::exponential_distribution<double> queueing(1.0 / 200.0);  // us
+    std::uniform_real_distribution<double> spike(2000.0, 8000.0);
+
+    ClockEstimator estimator;
+    PublishedClock published;
+    ClockFit first;
+
+    double max_error = 0.0;
+    double last_error = 0.0;
+    for (int i = 0; i < SAMPLES; ++i) {
+        std::int64_t device_us = device_start + i * PERIOD_US;
+        std::int64_t system_us = system_at(device_us);
+
+        double out_us = 20.0 + queueing(random);
+        double back_us = 20.0 + queueing(random) + ((i % 20 == 7) ? spike(random) : 0.0);
+        std::int64_t request = system_us - static_cast<std::int64_t>(out_us);
+        std::int64_t response = system_us + static_cast<std::int64_t>(back_us);
+
+        estimator.add(device_us, (request + response) / 2, response - request);
+        published.publish(estimator.fit());
+        if (i == 0) first = published.load();
+
+        // error where the next gaze samples land, half a period ahead
+        ClockFit fit = published.load();
+        std::int64_t probe = device_us + PERIOD_US / 2;
+        last_error = std::fabs(fit.map(probe) - static_cast<double>(system_at(probe)));
+        if (i >= SETTLE) max_error = (std::max)(max_error, last_error);
+    }
+
+    ClockFit fit = published.load();
+    std::int64_t end = device_start + SAMPLES * PERIOD_US;
+    double first_only_error = std::fabs(first.map(end) - static_cast<double>(system_at(end)));
+
+    log << "  " << SAMPLES << " samples, fitted skew " << fit.skewPpm() << " ppm (true " << SKEW_PPM << ")"
+        << ", max error " << max_error << " us, last " << last_error << " us"
+        << "; first sample only: " << first_only_error << " us\n";
+    return max_error < MAX_ERROR_US && std::fabs(fit.skewPpm() - SKEW_PPM) < 2.0;
+}
+
+
+/**
+ * @brief recordedSamplingRate finds the rate line anywhere in buffer.log
+ * and reports 0 when a session has none
+ */
+
+bool checkSessionRate(std::ostream& log) {
+    std::string dir = (std::filesystem::temp_directory_path() / "syncorder_selftest_rate").generic_string();
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    int missing = recordedSamplingRate(dir);
+    {
+        std::ofstream buffer_log(dir + "/buffer.log");
+        buffer_log << "time_to_first_frame_ms 12\n"
+                   << "clock_utc points=3 skew_ppm=1.5 residual_us=4 max_rtt_us=90\n"
+                   << SAMPLING_RATE_KEY << " 250\n";
+    }
+    int recorded = recordedSamplingRate(dir);
+    std::filesystem::remove_all(dir);
+
+    log << "  no buffer.log: " << missing << ", recorded: " << recorded << "\n";
+    return missing == 0 && recorded == 250;
+}
+
+
+/**
+ * @brief 600 Hz synthetic gaze through the recorder's own chain, with no drops
+ *
+ * SyntheticGazeSource -> TobiiCallback -> TobiiBuffer -> TobiiBroker -> csv,
+ * set up the way TobiiManager does it, stopped the way TobiiManager stops
+ * it. Every sample sent must be a row in tobii_data.csv, nothing may be
+ * dropped, and the whole process must stay under MAX_CPU_CORES.
+ */
+
+bool checkGazeRate(std::ostream& log) {
+    constexpr int RATE_HZ = 600;
+    constexpr int SECONDS = 5;
+    constexpr double MAX_CPU_CORES = 0.25;
+
+    std::string output = (std::filesystem::temp_directory_path() / "syncorder_selftest").generic_string() + "/";
+    std::filesystem::remove_all(output);
+
+    gonfig.output_path = output;
+    gonfig.tobii_sampling_rate = RATE_HZ;
+    gonfig.tobii_output_format = "csv";
+
+    SyntheticGazeSource source;
+    bool configured = false;
+    std::uint64_t rows = 0;
+    OverflowStats stats;
+    double cpu = 0.0;
+    double wall = 0.0;
+    {
+        TSConverter converter;  // no time sync: frame_timestamp stays on the system clock
+        TobiiCallback callback;
+        TobiiBuffer buffer;
+        TobiiBroker broker(true);
+
+        buffer.setCapacity(ringCapacity(RATE_HZ, gonfig.buffer_headroom_seconds));
+        OverflowOptions overflow;
+        overflow.block_timeout = std::chrono::milliseconds(gonfig.overflow_block_timeout_ms);
+        overflow.spill_path = output + "tobii/overflow.spill";
+        configured = buffer.setOverflowPolicy(parseOverflowPolicy(gonfig.tobii_overflow_policy), overflow);
+        log << "  overflow policy " << overflowPolicyName(buffer.overflowPolicy()) << (configured ? "" : " (fallback)") << "\n";
+
+        callback.setup(&buffer);
+        broker.pre_setup(&converter);
+        broker.setup(&buffer);
+        broker.setBatchInterval(RATE_HZ, std::chrono::milliseconds(gonfig.broker_batch_interval_ms));
+
+        broker.start();
+        buffer.start();
+
+        double cpu_begin = processCpuSeconds();
+        auto wall_begin = std::chrono::steady_clock::now();
+
+        source.start(RATE_HZ, &TobiiCallback::onGaze, &callback);
+        std::this_thread::sleep_for(std::chrono::seconds(SECONDS));
+        source.stop();
+
+        buffer.stop();
+        broker.stop();
+        buffer.discardRemaining();
+
+        cpu = processCpuSeconds() - cpu_begin;
+        wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_begin).count();
+
+        broker.cleanup();
+        stats = buffer.overflowStats();
+
+        const Histogram& delay = buffer.delayHistogram();
+        log << "  queueing delay (us) p50 " << delay.quantile(0.50) << ", p99 " << delay.quantile(0.99)
+            << ", max " << delay.maximum() << "; ring " << buffer.capacity() << ", high watermark " << buffer.highWatermark() << "\n";
+    }
+
+    CsvScanner scanner;
+    if (scanner.open(output + "tobii/tobii_data.csv")) {
+        scanner.header();
+        rows = scanner.countRows();
+    }
+    std::filesystem::remove_all(output);
+
+    double rate = source.sent() / wall;
+    double cores = cpu / wall;
+    log << "  " << source.sent() << " sent (" << rate << " Hz), " << rows << " rows written"
+        << ", dropped " << (stats.dropped_newest + stats.dropped_oldest) << ", discarded " << stats.discarded
+        << ", spilled " << stats.spilled << "; cpu " << cores * 100.0 << "% of one core\n";
+
+    return configured && rows == source.sent()
+        && stats.dropped_newest == 0 && stats.dropped_oldest == 0 && stats.discarded == 0
+        && rate >= RATE_HZ * 0.95
+        && cores < MAX_CPU_CORES;
+}
+
+
+/**
+ * @main
+ * Standalone checks of hot-path guarantees that need no device.
+ *
+ *   selftest.exe [name ...]
+ *
+ * Runs every check, or only the named ones, prints one line per check and
+ * exits non-zero if any failed.
+ */
+
+struct SelfTest {
+    const char* name;
+    bool (*run)(std::ostream& log);
+};
+
+int main(int argc, char* argv[]) {
+    const std::vector<SelfTest> tests = {
+        {"dequeue_allocations", &checkDequeueAllocations},
+        {"spill_policy", &checkSpillPolicy},
+        {"preview_slot", &checkPreviewSlot},
+        {"clock_drift", &checkClockDrift},
+        {"session_rate", &checkSessionRate},
+        {"gaze_rate", &checkGazeRate},
+    };
+
+    std::vector<std::string> wanted(argv + 1, argv + argc);
+
+    int failed = 0;
+    int ran = 0;
+    for (const auto& test : tests) {
+        bool selected = wanted.empty();
+        for (const auto& name : wanted) selected = selected || (name == test.name);
+        if (!selected) continue;
+
+        std::cout << "[selftest] " << test.name << "\n";
+        bool ok = test.run(std::cout);
+        std::cout << "[selftest] " << test.name << (ok ? " ok" : " FAILED") << "\n";
+
+        ran++;
+        if (!ok) failed++;
+    }
+
+    std::cout << "[selftest] " << (ran - failed) << "/" << ran << " passed\n";
+    return failed ? 1 : 0;
+}